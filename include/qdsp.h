@@ -9,18 +9,188 @@
 #ifndef _QDSP_H
 #define _QDSP_H
 
+#include <stddef.h>
 #include <time.h>
 #include <GLFW/glfw3.h>
 
+// number of frame times kept for the HUD graph
+#define QDSP_HUD_SAMPLES 120
+
+// number of text annotations per plot, see qdspSetText
+#define QDSP_MAX_TEXT 16
+
+// most vertices in a lasso selection, see qdspSetSelectCallback
+#define QDSP_MAX_LASSO 256
+
+// GPU buffers chunks of a file are streamed through, see qdspUpdateFile
+#define QDSP_STREAM_BUFFERS 3
+
+/** @name Automatic bounds modes
+ * Modes for @ref qdspSetAutoBounds.
+ * @{
+ */
+#define QDSP_AUTO_OFF 0 ///< Bounds are only set by @ref qdspSetBounds.
+#define QDSP_AUTO_TIGHT 1 ///< Fit the data exactly.
+#define QDSP_AUTO_PADDED 2 ///< Fit the data with a 5% margin on each side.
+#define QDSP_AUTO_PERCENTILE 3 ///< Fit the 0.5th to 99.5th percentiles.
+#define QDSP_AUTO_EXPAND 4 ///< Grow to fit the data, only shrink when it's much smaller.
+/** @} */
+
+/** @name Line joins
+ * Joins for @ref qdspSetLineStyle.
+ * @{
+ */
+#define QDSP_JOIN_MITER 0 ///< Sharp corners, with butt ends past a 4:1 miter.
+#define QDSP_JOIN_ROUND 1 ///< Rounded corners and ends.
+/** @} */
+
+/** @name Blend modes
+ * Modes for @ref qdspSetBlendMode.
+ * @{
+ */
+#define QDSP_BLEND_ALPHA 0 ///< Later points are drawn over earlier ones.
+#define QDSP_BLEND_ADD 1 ///< Points add up, whatever order they're drawn in.
+/** @} */
+
+/** @name Array types
+ * Element types for @ref QDSParray.
+ * @{
+ */
+#define QDSP_FLOAT64 0 ///< double, for coordinates.
+#define QDSP_FLOAT32 1 ///< float, for coordinates.
+#define QDSP_INT32 2 ///< int, for colors and masks.
+/** @} */
+
+/** @name Filter attributes
+ * Attributes for @ref qdspSetFilterRange.
+ * @{
+ */
+#define QDSP_FILTER_X 0 ///< The x coordinate.
+#define QDSP_FILTER_Y 1 ///< The y coordinate.
+#define QDSP_FILTER_VALUE 2 ///< The values from @ref qdspUpdateFilter.
+/** @} */
+
+/** An array in the caller's memory
+ *
+ * Elements can be any distance apart, so strided views of a larger array, or
+ * fields of an array of structs, can be passed without copying them first.
+ *
+ * @see @ref qdspUpdateArrays
+ */
+typedef struct QDSParray {
+	const void *data; ///< Address of the first element.
+	int type; ///< @ref QDSP_FLOAT64 or @ref QDSP_FLOAT32 for coordinates, @ref QDSP_INT32 for colors.
+	ptrdiff_t stride; ///< Bytes from one element to the next (may be negative), or 0 if packed.
+} QDSParray;
+
+/** A column of a file
+ *
+ * Like @ref QDSParray, but placed by its offset in a file, so columnar files
+ * (each column stored whole) and row-major files (records of several fields)
+ * can both be read.
+ *
+ * @see @ref qdspUpdateFile
+ */
+typedef struct QDSPcolumn {
+	long long offset; ///< Bytes from the start of the file to the first element.
+	int type; ///< @ref QDSP_FLOAT64 or @ref QDSP_FLOAT32 for coordinates, @ref QDSP_INT32 for colors.
+	ptrdiff_t stride; ///< Bytes from one element to the next (positive), or 0 if packed.
+} QDSPcolumn;
+
+/** One thread's share of a frame
+ *
+ * Pointers to the points a thread writes, from @ref qdspFrameSlice. Index 0 is
+ * the first point of the slice.
+ *
+ * @see @ref qdspBeginFrame
+ */
+typedef struct QDSPslice {
+	double *x; ///< The x coordinates, or NULL if the slice isn't in the frame.
+	double *y; ///< The y coordinates, or NULL if the slice isn't in the frame.
+	int *color; ///< The point colors, or NULL if the frame has none.
+} QDSPslice;
+
+/** Performance statistics for a plot
+ *
+ * Rates are averaged over a short window (about a quarter of a second) and
+ * refreshed as the plot is redrawn. GPU times are measured with timer queries
+ * and lag the current frame slightly.
+ *
+ * @see @ref qdspGetStats
+ */
+typedef struct QDSPstats {
+	double fps; ///< Redraws per second.
+	double frameMs; ///< Mean time between redraws, in milliseconds.
+	double pointsPerSec; ///< Points uploaded to the GPU per second.
+	double bytesPerSec; ///< Bytes uploaded to the GPU per second.
+
+	double gpuGridMs; ///< GPU time spent drawing gridlines, in milliseconds.
+	double gpuPointsMs; ///< GPU time spent drawing points, in milliseconds.
+	double gpuTextMs; ///< GPU time spent drawing labels, in milliseconds.
+
+	long long frames; ///< Total number of redraws.
+	long long pointsUploaded; ///< Total number of points uploaded.
+	long long bytesUploaded; ///< Total number of bytes uploaded.
+
+	double overhead; ///< Fraction of the time between updates spent inside them.
+	double budgetFps; ///< Update rate allowed by @ref qdspSetOverheadBudget, or 0 without a budget.
+	int pointStride; ///< Only every nth point is uploaded to stay in the overhead budget (1 for all).
+} QDSPstats;
+
+struct QDSPplot;
+
+/** Called when the point under the cursor changes
+ *
+ * @param plot The plot being hovered over.
+ * @param index The index of the point, in the arrays of the last update, or
+ *   -1 if there is no point under the cursor.
+ * @param data The pointer given to @ref qdspSetHoverCallback.
+ */
+typedef void (*QDSPhoverCallback)(struct QDSPplot *plot, int index, void *data);
+
+/** Called with the points selected with the mouse
+ *
+ * @param plot The plot the selection was made in.
+ * @param indices The indices of the selected points, in the arrays of the
+ *   last update, in no particular order. The array is only valid during the
+ *   call.
+ * @param count The number of selected points, 0 if the selection was cleared.
+ * @param data The pointer given to @ref qdspSetSelectCallback.
+ */
+typedef void (*QDSPselectCallback)(struct QDSPplot *plot, const int *indices, int count, void *data);
+
+// one character of text, defined in qdsp.c
+struct QDSPglyph;
+
+// a buffer's worth of points, defined in qdsp.c
+struct QDSPsegment;
+
 typedef struct QDSPplot {
 	GLFWwindow *window;
 
 	char *title;
+
+	// panels from qdspInitGrid share the window, and are swapped together; a
+	// lone plot is a grid of one. Events go to the active panel, which is
+	// only tracked by the first one.
+	struct QDSPplot **panels;
+	int numPanels;
+	int panelRow, panelCol;
+	int panelRows, panelCols;
+	struct QDSPplot *activePanel;
+	int panelUpdated; // new data since the window was drawn
+	int damage; // what changed since the panel was drawn, as DAMAGE_* flags
+	int closed;
+
+	// calls from other threads are passed to the render thread
+	int threaded;
 	
 	int paused;
 	int frozen;
+	int hidden; // minimized, so nothing is uploaded or drawn
 	int overlay;
 	int grid;
+	int hud;
 
 	int xAutoGrid, yAutoGrid;
 
@@ -28,10 +198,56 @@ typedef struct QDSPplot {
 	struct timespec lastUpdate;
 	double frameInterval;
 
+	// overhead budget: time spent in and out of updates over a short window,
+	// and the governor's choice of update interval and point stride
+	double overheadBudget;
+	struct timespec lastReturn;
+	struct timespec budgetStart;
+	double insideMs, outsideMs;
+	int budgetUpdates;
+	double budgetInterval;
+	int budgetStride;
+
+	// viewport origin and size of the panel, in pixels
+	int panelX, panelY;
+	int width, height;
+
+	int bgColor;
+
 	// bounds, we could probably use glGetUniform, but storing them is easier
 	double xMin, xMax;
 	double yMin, yMax;
 
+	// bounds requested by the application, restored by 'r'
+	double homeXMin, homeXMax;
+	double homeYMin, homeYMax;
+
+	// high precision mode: positions are sent as float offsets from the origin
+	int highPrecision;
+	double xOrigin, yOrigin;
+
+	// automatic bounds mode, and the range of the next frame's histograms
+	int autoBounds;
+	double autoRange[4];
+
+	// grid parameters, kept so the grid can follow the view
+	double xGridPoint, xGridInterval;
+	double yGridPoint, yGridInterval;
+	int xGridColor, yGridColor;
+
+	// interactive pan/zoom
+	int userView; // user has moved the view away from the home bounds
+	int dragging;
+	int boxing;
+	double cursorX, cursorY;
+	double boxX, boxY;
+
+	// box or lasso selection, instead of zooming
+	int boxSelect;
+	int lassoing;
+	float lasso[2 * QDSP_MAX_LASSO];
+	int numLasso;
+
 	int connected;
 	
 	// opengl stuff:
@@ -41,26 +257,169 @@ typedef struct QDSPplot {
 	unsigned int pointsVBOy;
 	unsigned int pointsVBOrgb;
 
+	// thick lines, drawn from the point buffers through texture buffers
+	int linesProgram;
+	unsigned int linesVAO;
+	unsigned int lineTextures[4];
+	int maxLinePoints;
+
+	// separate curves, from qdspUpdateCurves: a table of (start, count,
+	// color) for the lines program, and starts and counts for the fallback
+	int curveMode;
+	unsigned int curvesVBO;
+	int *curveTable;
+	int *curveFirst;
+	int *curveCount;
+	int numCurves, curveCapacity;
+
 	int gridProgram;
-	unsigned int gridVAOx;
-	unsigned int gridVBOx;
-	unsigned int gridVAOy;
-	unsigned int gridVBOy;
+	unsigned int gridVAO;
 
 	int textProgram;
-	unsigned int textVAOx;
-	unsigned int textVBOx;
-	unsigned int textVAOy;
-	unsigned int textVBOy;
-	unsigned int numTexture;
+	unsigned int textVAO;
+	unsigned int textVBO;
+	unsigned int textTexture;
+
+	// all visible text (grid labels, HUD numbers, annotations) is gathered
+	// into one instance buffer, one record per character, and drawn at once
+	struct QDSPglyph *gridGlyphs[2];
+	int numGridGlyphs[2];
+	struct QDSPglyph *hudGlyphs;
+	struct QDSPglyph *glyphs;
+	int numGlyphs, glyphCapacity;
+	int textDirty;
+	char *text[QDSP_MAX_TEXT];
+	float textPos[QDSP_MAX_TEXT][2];
+
+	// persistence: points accumulate in an offscreen buffer that fades by
+	// the decay factor every frame
+	double persistence;
+	int persistClear;
+	int persistProgram;
+	unsigned int persistVAO;
+	unsigned int persistFBO;
+	unsigned int persistTexture;
+
+	// particle trails: a ring of the last trailLength frames of positions of
+	// the first trailCount points, copied buffer to buffer on the GPU
+	int trailLength, trailCount;
+	int trailHead, trailFilled;
+	int trailsProgram;
+	unsigned int trailsVAO;
+	unsigned int trailVBOs[2];
+	unsigned int trailTextures[2];
 
 	int overlayProgram;
 	unsigned int overlayVAO;
 	unsigned int overlayVBO;
 	unsigned int overlayTexture;
+	int helpDims[2];
+
+	// performance HUD, geometry is allocated once and refilled in place
+	unsigned int hudTexture;
+	int hudDims[2];
+	unsigned int hudGraphVAO;
+	unsigned int hudGraphVBO;
+
+	unsigned int boxVAO;
+	unsigned int boxVBO;
+	float *hudGraph;
+
+	// picking and selection: hovering draws point indices around the cursor
+	// into a small integer target, and selections run the points through
+	// transform feedback; both are read back once the GPU has finished
+	QDSPhoverCallback hoverCallback;
+	void *hoverData;
+	QDSPselectCallback selectCallback;
+	void *selectData;
+	int pickProgram;
+	unsigned int pickFBO, pickRBO, pickPBO;
+	void *pickFence;
+	int pickPending, pickStride;
+	int hovered;
+	int selectProgram;
+	unsigned int selectVAO, selectVBO, selectQuery;
+	void *selectFence;
+	int selectPending, selectCapacity;
+	int numSelected;
+	int highlightProgram;
+	unsigned int lassoVAO, lassoVBO, lassoTexture;
+
+	// visibility filter, applied by the vertex shaders: ranges on x, y and
+	// the filter values, and the mask classes shown, with the values and
+	// masks in texture buffers
+	double filterRange[3][2];
+	unsigned int filterClasses;
+	unsigned int filterVBOs[2];
+	unsigned int filterTextures[2];
+	int hasValues, hasMask;
+	int numFiltered;
+
+	// out-of-core data from qdspUpdateFile: the file stays mapped, and is
+	// converted a chunk at a time into a small ring of buffers, drawn, and
+	// accumulated in an offscreen target that's redrawn from while the view
+	// doesn't change
+	int streaming;
+	void *streamMap;
+	size_t streamSize;
+	QDSParray streamColumns[3];
+	int streamHasColor;
+	long long streamPoints;
+	unsigned int streamFBO;
+	unsigned int streamTexture;
+	unsigned int streamVAOs[QDSP_STREAM_BUFFERS];
+	unsigned int streamVBOs[QDSP_STREAM_BUFFERS][3];
+	void *streamFences[QDSP_STREAM_BUFFERS];
+
+	// stats, accumulated over a short window and then folded into stats
+	QDSPstats stats;
+	struct timespec lastRedraw;
+	struct timespec statsStart;
+	int statsFrames;
+	long long statsPoints;
+	long long statsBytes;
+	float frameMs[QDSP_HUD_SAMPLES];
+	int frameIdx;
+
+	// GPU timer queries (grid, points, labels), double buffered
+	unsigned int gpuQueries[2][3];
+	int gpuQueryUsed[2];
+	int gpuQueryIdx;
+	double statsGpuMs[3];
+	int statsGpuFrames;
+
+	// points that don't fit in one buffer are split into segments, each with
+	// its own buffers and vertex array; the first is pointsVAO and its
+	// buffers. Line strips are split with the last point of each segment
+	// repeated at the start of the next, so they stay joined.
+	struct QDSPsegment *segments;
+	int numSegments, segmentCapacity;
+	size_t segmentPoints; // most points in one segment
+	int segmentOverlap;
+
+	// spatial sort: Morton keys of the points' screen tiles, by index, and
+	// the order they were uploaded in, kept while it stays nearly sorted
+	int spatialSort;
+	unsigned int *sortKeys;
+	unsigned int *sortOrder;
+	size_t sortCapacity, sortCount;
+	int sortValid;
+
+	int blendMode;
+
+	// frame being written by several threads: straight into the mapped point
+	// buffers, or into staging memory that QDSP never touches itself, so
+	// each page ends up near the thread that writes it first
+	int frameOpen, frameMapped, frameHasColor;
+	size_t framePoints;
+	double *frameX, *frameY;
+	int *frameColor;
+	void *frameStaging;
+	size_t frameStagingSize;
 
 	// needed so we can redraw at will
-	int numPoints;
+	size_t numPoints;
+	int uploadStride; // points on the GPU are every nth one passed in
 	int numGridX;
 	int numGridY;
 
@@ -69,7 +428,9 @@ typedef struct QDSPplot {
 
 /** Destroys a plot.
  *
- * The plot object is freed and all resources are deleted.
+ * The plot object is freed and all resources are deleted. Panels created by
+ * @ref qdspInitGrid share a window, so deleting any of them deletes them all.
+ * Deleting a plot from @ref qdspInitThreaded deletes every threaded plot.
  *
  * @param plot The plot to destroy.
  *
@@ -91,9 +452,74 @@ void qdspDelete(QDSPplot *plot);
  */
 QDSPplot *qdspInit(const char *title);
 
+/** Creates a window divided into a grid of plots.
+ *
+ * A new window with the given title is split evenly into rows and columns of
+ * panels. Each panel is a plot, with its own bounds, grid, settings and data,
+ * and is used with the same functions as a plot from @ref qdspInit.
+ *
+ * The panels are drawn into one framebuffer, which is swapped once per frame:
+ * the window is redrawn after every panel has been updated, or when a panel is
+ * updated a second time before that, so panels that are updated less often
+ * don't hold the others back. Mouse and keyboard controls act on the panel
+ * under the cursor, except that pausing, freezing and closing act on the whole
+ * window.
+ *
+ * @param title The window title.
+ * @param rows The number of rows of panels.
+ * @param cols The number of columns of panels.
+ *
+ * @return An array of rows * cols panels, row by row from the top left, or
+ *   NULL if the window could not be created. The array belongs to QDSP, and is
+ *   freed by @ref qdspDelete.
+ *
+ * @see @ref qdspDelete
+ */
+QDSPplot **qdspInitGrid(const char *title, int rows, int cols);
+
+/** Creates a plot run by a render thread
+ *
+ * The window is created and owned by a render thread inside QDSP, which keeps
+ * handling its events and redrawing it while the application computes. Every
+ * function can then be called on the plot from any thread: calls are passed to
+ * the render thread through a lock-free queue, in the order they're made.
+ * Setters return at once. Updates return as soon as their data has been copied
+ * to the GPU, without waiting for the frame to be drawn, and
+ * @ref qdspUpdateArraysAsync doesn't wait at all.
+ *
+ * Threaded plots can't be mixed with plots from @ref qdspInit in one process.
+ * They can be created and deleted from any thread. Deleting one shuts the
+ * render thread down, along with every window on it, and frees every threaded
+ * plot, so none of their handles can be used again.
+ *
+ * @param title The window title.
+ *
+ * @return A pointer to the plot handle, or NULL if a plot could not be created.
+ *
+ * @see @ref qdspInitGridThreaded
+ * @see @ref qdspDelete
+ */
+QDSPplot *qdspInitThreaded(const char *title);
+
+/** Creates a window divided into a grid of plots, run by a render thread
+ *
+ * This is @ref qdspInitGrid for threaded plots; see @ref qdspInitThreaded.
+ *
+ * @param title The window title.
+ * @param rows The number of rows of panels.
+ * @param cols The number of columns of panels.
+ *
+ * @return An array of rows * cols panels, row by row from the top left, or
+ *   NULL if the window could not be created.
+ */
+QDSPplot **qdspInitGridThreaded(const char *title, int rows, int cols);
+
 /** Redraws a plot.
  *
  * The given plot is redrawn immediately, ignoring any specified framerate.
+ * For panels, the whole window is redrawn. If nothing has changed since the
+ * last redraw (no new data, settings, view, grid, or text), or the window is
+ * minimized, nothing is drawn and the last frame stays on screen.
  *
  * @param plot The plot to redraw.
  *
@@ -103,6 +529,106 @@ QDSPplot *qdspInit(const char *title);
  */
 void qdspRedraw(QDSPplot *plot);
 
+/** Handles window events without updating a plot
+ *
+ * This keeps a plot responsive while the application is busy between updates:
+ * pending mouse and keyboard events are processed, and if the view was changed
+ * interactively, the plot is redrawn from the data already on the GPU.
+ *
+ * @param plot The plot to act on.
+ *
+ * @return 0 if the window has been closed, 1 otherwise.
+ *
+ * @see @ref qdspUpdate
+ */
+int qdspPoll(QDSPplot *plot);
+
+/** Calls a function when the point under the cursor changes
+ *
+ * Picking is done on the GPU: the points around the cursor are drawn with
+ * their indices into a small offscreen target, which is read back a frame
+ * later, so hovering over millions of points doesn't stall the plot. The
+ * nearest point within a few pixels of the cursor is reported.
+ *
+ * Callbacks are made while the plot handles window events, from within
+ * @ref qdspUpdate and the other update functions, @ref qdspPoll, and while
+ * paused; threaded plots make them on the render thread. They shouldn't
+ * update or delete the plot.
+ *
+ * @param plot The plot to act on.
+ * @param callback The function to call, or NULL to stop picking.
+ * @param data A pointer passed on to the callback.
+ *
+ * @see @ref qdspSetSelectCallback
+ */
+void qdspSetHoverCallback(QDSPplot *plot, QDSPhoverCallback callback, void *data);
+
+/** Calls a function with the points selected with the mouse
+ *
+ * Dragging with the left button while holding shift draws a lasso, and
+ * dragging with the right button while holding shift draws a box. The points
+ * inside are found on the GPU with transform feedback, highlighted, and
+ * passed to the callback by index. Highlights follow the indices as the plot
+ * is updated, and are cleared by pressing 'c', which calls the callback with
+ * no points.
+ *
+ * Lassos are limited to @ref QDSP_MAX_LASSO vertices. Callbacks are made as
+ * described for @ref qdspSetHoverCallback.
+ *
+ * @param plot The plot to act on.
+ * @param callback The function to call, or NULL to only highlight the
+ *   selection.
+ * @param data A pointer passed on to the callback.
+ *
+ * @see @ref qdspSetHoverCallback
+ */
+void qdspSetSelectCallback(QDSPplot *plot, QDSPselectCallback callback, void *data);
+
+/** Only shows points with an attribute in a range
+ *
+ * Points outside the range are hidden. They can't be picked or selected
+ * either. Filters are applied on the GPU as the points are drawn, so changing
+ * one is as cheap as changing the bounds, and nothing is uploaded again.
+ * Ranges on different attributes are combined, along with
+ * @ref qdspSetFilterClasses. In connected mode, segments with a hidden end
+ * are left out.
+ *
+ * @param plot The plot to act on.
+ * @param attribute The attribute to filter on, one of @ref QDSP_FILTER_X,
+ *   @ref QDSP_FILTER_Y, or @ref QDSP_FILTER_VALUE.
+ * @param min The smallest value shown.
+ * @param max The largest value shown. Pass -INFINITY and INFINITY to remove
+ *   the filter.
+ *
+ * @see @ref qdspUpdateFilter
+ */
+void qdspSetFilterRange(QDSPplot *plot, int attribute, double min, double max);
+
+/** Only shows points in some mask classes
+ *
+ * Each point has a class from 0 to 31 in the mask given to
+ * @ref qdspUpdateFilter, such as a species, or 0 and 1 for a plain mask.
+ * Points in classes that aren't set here are hidden, like points outside a
+ * range from @ref qdspSetFilterRange. All classes are shown by default.
+ *
+ * @param plot The plot to act on.
+ * @param classes The classes shown, as a bitmask: bit n shows class n.
+ *
+ * @see @ref qdspUpdateFilter
+ */
+void qdspSetFilterClasses(QDSPplot *plot, unsigned int classes);
+
+/** Gets performance statistics for a plot
+ *
+ * This function copies the plot's current performance statistics into the
+ * given struct. The same numbers are shown by the on-screen HUD, which can be
+ * toggled by pressing 's'.
+ *
+ * @param plot The plot to query.
+ * @param stats The struct to fill.
+ */
+void qdspGetStats(QDSPplot *plot, QDSPstats *stats);
+
 /** Sets the background color
  *
  * This function sets the background color of the plot area.
@@ -122,6 +648,14 @@ void qdspSetBGColor(QDSPplot *plot, int rgb);
  * This function sets the bounds of the plot window. The default bounds are
  * (-1,-1) to (1,1).
  *
+ * The view can also be changed interactively: the scroll wheel zooms around
+ * the cursor, dragging with the left mouse button pans, and dragging with the
+ * right mouse button zooms to the selected box. This only changes the
+ * transformation applied on the GPU, so no point data is re-uploaded, and it
+ * works while the plot is paused or frozen. While the view has been changed
+ * interactively, calls to this function only change the bounds that 'r'
+ * resets the view to.
+ *
  * @param plot The plot to act on.
  * @param xMin The x coordinate of the plot's left boundary.
  * @param xMax The x coordinate of the plot's right boundary.
@@ -130,6 +664,99 @@ void qdspSetBGColor(QDSPplot *plot, int rgb);
  */
 void qdspSetBounds(QDSPplot *plot, double xMin, double xMax, double yMin, double yMax);
 
+/** Fits the plot bounds to the data automatically
+ *
+ * This function makes QDSP compute the bounds of the plot from the data passed
+ * to each update, instead of relying on @ref qdspSetBounds. The data range is
+ * computed with a parallel, vectorized reduction while the data is copied to
+ * the GPU, so it costs little more than a regular update. To avoid jitter,
+ * small changes in the fitted bounds are ignored.
+ *
+ * Percentile fitting uses a histogram built around the previous frame's
+ * percentiles, so it lags the data by a frame or two.
+ *
+ * @param plot The plot to act on.
+ * @param mode One of @ref QDSP_AUTO_OFF (the default), @ref QDSP_AUTO_TIGHT,
+ *   @ref QDSP_AUTO_PADDED, @ref QDSP_AUTO_PERCENTILE, or
+ *   @ref QDSP_AUTO_EXPAND.
+ *
+ * @see @ref qdspSetBounds
+ */
+void qdspSetAutoBounds(QDSPplot *plot, int mode);
+
+/** Enables camera-relative, high precision coordinates
+ *
+ * Positions are drawn with single precision on the GPU, so small views far
+ * from the origin (say, a width of 1e-3 around x = 1e6) look blocky. In high
+ * precision mode, QDSP subtracts a double precision origin near the view from
+ * each point while copying it to the GPU, and sends the offsets as floats.
+ * This keeps full precision around the view and halves the upload size.
+ *
+ * The origin only moves when an update happens while the view is far away
+ * from it, so zooming deep into a paused plot is limited to the precision of
+ * the last update.
+ *
+ * @param plot The plot to act on.
+ * @param enabled Nonzero to enable high precision mode, zero to disable it
+ *   (the default).
+ */
+void qdspSetHighPrecision(QDSPplot *plot, int enabled);
+
+/** Sets a text annotation
+ *
+ * This function places a line of text, such as the current time step, in the
+ * plot window. Each plot has @ref QDSP_MAX_TEXT annotation slots; setting a
+ * slot again replaces its text, so it's cheap to call every frame. Text is
+ * drawn with the same font as the grid labels, in the same draw call, and
+ * newlines start a new line below the first.
+ *
+ * @param plot The plot to act on.
+ * @param slot The annotation to set, from 0 to @ref QDSP_MAX_TEXT - 1.
+ * @param x The horizontal position of the start of the text, as a fraction of
+ *   the window width from the left edge.
+ * @param y The vertical position of the bottom of the first line, as a
+ *   fraction of the window height from the bottom edge.
+ * @param text The text to show, or NULL to remove the annotation. Characters
+ *   outside of printable ASCII are shown as '?'.
+ */
+void qdspSetText(QDSPplot *plot, int slot, double x, double y, const char *text);
+
+/** Leaves fading trails behind the points
+ *
+ * In persistence mode, points are drawn into an offscreen buffer that is
+ * faded by the given factor every frame, like the phosphor of an analog
+ * oscilloscope, so earlier positions stay visible as faint trails. The cost is
+ * a fixed fade and copy pass per frame, however long the trails are. The
+ * buffer is cleared when the bounds change or the window is resized.
+ *
+ * @param plot The plot to act on.
+ * @param decay The fraction of brightness kept from one frame to the next,
+ *   from 0 to 1; for example, 0.95 fades trails out over about a hundred
+ *   frames. 0 disables persistence (the default).
+ */
+void qdspSetPersistence(QDSPplot *plot, double decay);
+
+/** Draws the recent path of each particle
+ *
+ * The positions of the first count points from each of the last length
+ * updates are kept in a ring on the GPU, and each of those points is drawn
+ * with a line through its past positions, fading out with age. Positions are
+ * copied into the ring on the GPU, so uploads cost the same as without
+ * trails, and drawing costs about length times as much as the points
+ * themselves. Put the particles to follow at the start of the arrays, in the
+ * same order every update.
+ *
+ * The ring is cleared when the number of points drops below count, or when
+ * the precision mode changes.
+ *
+ * @param plot The plot to act on.
+ * @param length The number of past positions to keep for each particle. Less
+ *   than 2 disables trails (the default).
+ * @param count The number of points, from the start of the arrays, to draw
+ *   trails for.
+ */
+void qdspSetTrails(QDSPplot *plot, int length, int count);
+
 /** Specifies whether to connect the plot points
  * 
  * This function tells QDSP whether the points in the specified plot should be
@@ -137,12 +764,70 @@ void qdspSetBounds(QDSPplot *plot, double xMin, double xMax, double yMin, double
  * Points will always be connected in the order they appear in in the input
  * array.
  *
+ * Lines are drawn as antialiased segments, with the width and joins set by
+ * @ref qdspSetLineStyle. A NaN coordinate breaks the line.
+ *
  * @param plot The plot to act on.
  * @param connected Zero if the points should be disconnected, nonzero if they
  *   should be connected.
  */
 void qdspSetConnected(QDSPplot *plot, int connected);
 
+/** Sets the width and joins of connected lines
+ *
+ * This function sets how lines are drawn in connected mode (see
+ * @ref qdspSetConnected). Each segment is drawn on the GPU straight from the
+ * uploaded points, with analytic antialiasing, so thick lines cost about as
+ * much to upload as thin ones. The default is a 1 pixel line with miter
+ * joins.
+ *
+ * @param plot The plot to act on.
+ * @param width The line width, in pixels.
+ * @param join @ref QDSP_JOIN_MITER or @ref QDSP_JOIN_ROUND.
+ *
+ * @see @ref qdspSetConnected
+ */
+void qdspSetLineStyle(QDSPplot *plot, double width, int join);
+
+/** Specifies whether to sort points by where they land on screen
+ *
+ * Dense clouds of points in random order scatter the GPU's framebuffer
+ * writes. With sorting on, points are uploaded in the Morton order of the
+ * small screen tiles they fall in, which keeps nearby points together. The
+ * sort is a parallel radix sort on the CPU, and the last order is reused while
+ * the points have barely moved, as particles do between steps. It pays off for
+ * millions of points on fill-rate bound GPUs (large or blended points); see
+ * 'make bench' to measure it.
+ *
+ * Sorting changes the order points are drawn in, so where points of different
+ * colors overlap, a different one may end up on top. It's skipped for fewer
+ * than 65536 points and whenever something depends on the order: connected
+ * points, curves, trails, hover and select callbacks, filter data, and a
+ * selection being highlighted.
+ *
+ * By default points are drawn in the order given.
+ *
+ * @param plot The plot to act on.
+ * @param enabled Nonzero to sort points, zero to draw them in order.
+ */
+void qdspSetSpatialSort(QDSPplot *plot, int enabled);
+
+/** Sets how overlapping points are blended
+ *
+ * With @ref QDSP_BLEND_ALPHA, the default, each point is drawn over the ones
+ * before it, so the order matters where points of different colors overlap.
+ * With @ref QDSP_BLEND_ADD, each point's color, scaled by the point alpha
+ * (see @ref qdspSetPointAlpha), is added to what's there, up to full
+ * brightness. Sums don't depend on order, so frames assembled by several
+ * threads (see @ref qdspFrameSlice) or spatially sorted points (see
+ * @ref qdspSetSpatialSort) look the same however they're ordered, and dense
+ * regions show up brighter.
+ *
+ * @param plot The plot to act on.
+ * @param mode @ref QDSP_BLEND_ALPHA or @ref QDSP_BLEND_ADD.
+ */
+void qdspSetBlendMode(QDSPplot *plot, int mode);
+
 /** Sets the locations of x gridlines
  *
  * This function determines the spacing of the x gridlines. Gridlines will be
@@ -179,6 +864,18 @@ void qdspSetGridX(QDSPplot *plot, double point, double interval, int rgb);
  */
 void qdspSetGridY(QDSPplot *plot, double point, double interval, int rgb);
 
+/** Shows or hides the gridlines
+ *
+ * Gridlines are hidden by default, and can also be toggled by pressing 'g'.
+ *
+ * @param plot The plot to act on.
+ * @param visible 1 to show the gridlines, 0 to hide them.
+ *
+ * @see @ref qdspSetGridX
+ * @see @ref qdspSetGridY
+ */
+void qdspSetGridVisible(QDSPplot *plot, int visible);
+
 /** Caps the update framerate of a plot
  *
  * This function sets a framerate for updating the specified plot, which will be
@@ -196,6 +893,27 @@ void qdspSetGridY(QDSPplot *plot, double point, double interval, int rgb);
  */
 void qdspSetFramerate(QDSPplot *plot, double framerate);
 
+/** Limits plotting to a fraction of the application's time
+ *
+ * QDSP measures how long updates to the plot take against the time spent
+ * between them, and adapts so that updates take at most the given fraction of
+ * the total. Updates that come too soon after the last one are dropped,
+ * returning 2 as @ref qdspUpdateIfReady does. If keeping to the budget that
+ * way would take the plot below 10 FPS, only every nth point is uploaded
+ * instead; connected points and curves are never thinned out. The framerate
+ * set with @ref qdspSetFramerate still applies, and the governor's decisions
+ * are reported by @ref qdspGetStats.
+ *
+ * By default there is no budget.
+ *
+ * @param plot The plot to act on.
+ * @param fraction The fraction of time, between 0 and 1, or 0 to remove the
+ *   budget.
+ *
+ * @see @ref qdspGetStats
+ */
+void qdspSetOverheadBudget(QDSPplot *plot, double fraction);
+
 /** Sets the point transparency
  * 
  * This function sets the transparency of the plotted points.
@@ -229,7 +947,7 @@ void qdspSetPointColor(QDSPplot *plot, int rgb);
  * 
  * This function sets the size of the points drawn by QDSP. Points will appear
  * as squares of the specified width. The width parameter defaults to 1 pixel,
- * and will be ignored in connected mode.
+ * and will be ignored in connected mode (see @ref qdspSetLineStyle).
  *
  * @param plot The plot to act on.
  * @param pixels The point width, in pixels.
@@ -264,6 +982,37 @@ void qdspSetPointSize(QDSPplot *plot, int pixels);
  */
 int qdspUpdate(QDSPplot *plot, double *x, double *y, int *color, int numPoints);
 
+/** Updates a plot with many separate curves
+ *
+ * This function works like @ref qdspUpdate, but draws the points as separate
+ * lines: curve i connects counts[i] points, starting at index starts[i] of x
+ * and y. All curves are uploaded together and drawn in a single call, so a
+ * thousand curves cost about as much as one long curve, and the plot is drawn
+ * as lines whether or not it's in connected mode (see
+ * @ref qdspSetLineStyle). Curves are drawn in the default color if colors is
+ * NULL.
+ *
+ * Curves must be in order and can't overlap, though there can be unused points
+ * between them. A single curve can also be broken with a NaN coordinate.
+ *
+ * @param plot The plot to update.
+ * @param x An array containing the x coordinates.
+ * @param y An array containing the y coordinates.
+ * @param numPoints The total number of points, in all curves.
+ * @param starts The index of the first point of each curve.
+ * @param counts The number of points in each curve.
+ * @param colors An array containing one color per curve, or NULL. See
+ *   @ref qdspSetBGColor for a description of the color format.
+ * @param numCurves The number of curves.
+ *
+ * @return 1 if the plot was updated successfully, 0 otherwise (including when
+ *   the curves overlap or go past numPoints).
+ *
+ * @see @ref qdspUpdate
+ */
+int qdspUpdateCurves(QDSPplot *plot, double *x, double *y, int numPoints,
+                     int *starts, int *counts, int *colors, int numCurves);
+
 /** Updates a plot if enough time has passed since the last update.
  *
  * The plot is updated with the new vertex data and redrawn if at least
@@ -320,4 +1069,226 @@ int qdspUpdateIfReady(QDSPplot *plot, double *x, double *y, int *color, int numP
  */
 int qdspUpdateWait(QDSPplot *plot, double *x, double *y, int *color, int numPoints);
 
+/** Updates a plot from arrays of any supported type and stride
+ *
+ * This works like @ref qdspUpdate, but coordinates can be floats or doubles,
+ * and neither they nor the colors have to be packed. Anything that isn't
+ * packed doubles is gathered and converted a cache-sized chunk at a time while
+ * it's copied to the GPU, so there's never a full copy of the caller's data.
+ *
+ * @param plot The plot to update.
+ * @param x The x coordinates.
+ * @param y The y coordinates.
+ * @param color The point colors, or NULL (as is a color array with NULL
+ *   data). See @ref qdspSetBGColor for a description of the color format.
+ * @param numPoints The number of points to render.
+ *
+ * @return 1 if the plot was updated successfully, 0 otherwise (including for
+ *   an unsupported array type).
+ *
+ * @see @ref qdspUpdateArraysIfReady
+ * @see @ref qdspUpdateArraysWait
+ */
+int qdspUpdateArrays(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                     const QDSParray *color, int numPoints);
+
+/** Updates a plot from arrays with more points than fit in an int
+ *
+ * This is @ref qdspUpdateArrays with a 64-bit point count. Points are split
+ * across as many GPU buffers as they need, each kept well under the size
+ * drivers allow for one buffer, and drawn with a call per buffer; data that
+ * fits in one buffer is uploaded and drawn exactly as before. Hover and
+ * selection callbacks report int indices, so only the first 2^31 points can
+ * be picked or selected, and thick lines are only drawn for data that fits in
+ * one buffer.
+ *
+ * @param plot The plot to update.
+ * @param x The x coordinates.
+ * @param y The y coordinates.
+ * @param color The point colors, or NULL.
+ * @param numPoints The number of points to render.
+ *
+ * @return 1 if the plot was updated successfully, 0 otherwise.
+ *
+ * @see @ref qdspUpdateArrays
+ */
+int qdspUpdateArraysLarge(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                          const QDSParray *color, size_t numPoints);
+
+/** Updates a plot from arrays if enough time has passed since the last update.
+ *
+ * This is @ref qdspUpdateIfReady for @ref QDSParray inputs.
+ *
+ * @return 1 if the plot was updated successfully, 2 if plot was not ready for
+ * an update, 0 otherwise.
+ *
+ * @see @ref qdspUpdateArrays
+ */
+int qdspUpdateArraysIfReady(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                            const QDSParray *color, int numPoints);
+
+/** Updates a plot from arrays after waiting for a new frame
+ *
+ * This is @ref qdspUpdateWait for @ref QDSParray inputs.
+ *
+ * @return 1 if the plot was updated successfully, 0 otherwise.
+ *
+ * @see @ref qdspUpdateArrays
+ */
+int qdspUpdateArraysWait(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                         const QDSParray *color, int numPoints);
+
+/** Queues an update from arrays without waiting for it
+ *
+ * For a plot from @ref qdspInitThreaded, the update is passed to the render
+ * thread and this returns immediately. The arrays are read later, so they must
+ * not be changed or freed until @ref qdspWaitUpdate has returned for the
+ * ticket. For other plots, this is @ref qdspUpdateArrays, and the ticket is
+ * finished on return.
+ *
+ * @param plot The plot to update.
+ * @param x The x coordinates.
+ * @param y The y coordinates.
+ * @param color The point colors, or NULL.
+ * @param numPoints The number of points to render.
+ *
+ * @return A ticket for @ref qdspWaitUpdate.
+ *
+ * @see @ref qdspUpdateArrays
+ */
+long long qdspUpdateArraysAsync(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                                const QDSParray *color, int numPoints);
+
+/** Waits until the data of a queued update has been read
+ *
+ * After this returns, the arrays passed to @ref qdspUpdateArraysAsync for the
+ * ticket can be reused. Tickets count up, so waiting for the latest one also
+ * waits for every update queued before it.
+ *
+ * @param plot The plot the update was queued for.
+ * @param ticket The ticket returned by @ref qdspUpdateArraysAsync.
+ *
+ * @return 0 if the window has been closed, 1 otherwise.
+ */
+int qdspWaitUpdate(QDSPplot *plot, long long ticket);
+
+/** Uploads per-point data to filter on
+ *
+ * Values (a speed, say) can be limited to a range by
+ * @ref qdspSetFilterRange, and mask classes can be chosen with
+ * @ref qdspSetFilterClasses. Both follow the points by index, in the order
+ * they're passed to the update functions, so they only need uploading when
+ * they change. Values are stored as floats. Points past the end of the
+ * filter data are only filtered by position.
+ *
+ * @param plot The plot to act on.
+ * @param values Values for @ref QDSP_FILTER_VALUE, of type
+ *   @ref QDSP_FLOAT64 or @ref QDSP_FLOAT32, or NULL to filter on none.
+ * @param mask Mask classes of type @ref QDSP_INT32, from 0 to 31, or NULL
+ *   to put every point in class 0.
+ * @param numPoints The number of points the data is for.
+ *
+ * @return 0 if the window has been closed or an array type isn't supported,
+ *   1 otherwise.
+ */
+int qdspUpdateFilter(QDSPplot *plot, const QDSParray *values, const QDSParray *mask,
+                     int numPoints);
+
+/** Plots points from a file too large to load
+ *
+ * The file is memory-mapped, and its points are converted and streamed to the
+ * GPU in chunks through a ring of @ref QDSP_STREAM_BUFFERS fixed-size buffers,
+ * each chunk drawn as soon as it's copied. Chunks accumulate in an offscreen
+ * target, so memory use doesn't grow with the file: a few chunks of it are
+ * resident at a time, and pages that have been drawn are dropped. The file is
+ * streamed again whenever the view or the point style changes, and otherwise
+ * redrawn from the target.
+ *
+ * Points are drawn as single points, as floats relative to the high precision
+ * origin. The bounds aren't fitted to the file, and streamed points can't be
+ * picked, selected, given trails, or filtered by value or class, though the
+ * position filters apply. The file stays mapped until the next update, and
+ * shouldn't be changed until then (truncating it can crash the program).
+ *
+ * @param plot The plot to update.
+ * @param path The file to read.
+ * @param x Where the x coordinates are in the file.
+ * @param y Where the y coordinates are in the file.
+ * @param color Where the point colors are in the file, or NULL.
+ * @param numPoints The number of points to render.
+ *
+ * @return 1 if the plot was updated successfully, 2 if plot was not ready for
+ *   an update, 0 if the window has been closed, the file can't be mapped, or
+ *   a column type isn't supported or runs past the end of the file.
+ *
+ * @see @ref qdspUpdateArrays
+ */
+int qdspUpdateFile(QDSPplot *plot, const char *path, const QDSPcolumn *x,
+                   const QDSPcolumn *y, const QDSPcolumn *color, long long numPoints);
+
+/** Starts a frame that several threads write at once
+ *
+ * Instead of passing arrays, threads that each own a share of the particles
+ * can write them straight into the frame: call this from the thread that
+ * updates the plot, then @ref qdspFrameSlice from each thread for its own
+ * share, and finally @ref qdspEndFrame once they're all done. For example,
+ * inside an OpenMP parallel region with a static schedule:
+ *
+ *     QDSPslice s = qdspFrameSlice(plot, offset, count);
+ *     for (int i = 0; i < count; i++) {
+ *         s.x[i] = x[offset + i];
+ *         s.y[i] = v[offset + i];
+ *     }
+ *
+ * When the points can go to the GPU as they are (automatic bounds, high
+ * precision mode, and spatial sorting all off, and not a threaded plot), and
+ * the plot isn't frozen, paused, minimized, or held back by its overhead
+ * budget, the slices are in the point buffers themselves, mapped for writing,
+ * and nothing is copied. Otherwise they're in staging memory that's uploaded by
+ * @ref qdspEndFrame. QDSP never touches staging memory itself, so on NUMA
+ * machines each page is placed near the thread that writes it first; it's
+ * kept from frame to frame, so a thread should write the same slice every
+ * frame.
+ *
+ * Between this and @ref qdspEndFrame, nothing else may be done with the plot:
+ * updates fail, and while the point buffers are mapped the window isn't
+ * redrawn.
+ *
+ * @param plot The plot to act on.
+ * @param numPoints The number of points in the frame.
+ * @param hasColor Nonzero if the frame has point colors.
+ *
+ * @return 1 if the frame was started, 0 if the window has been closed, a frame
+ *   is already open, or memory couldn't be found for it.
+ */
+int qdspBeginFrame(QDSPplot *plot, size_t numPoints, int hasColor);
+
+/** Finds where a thread writes its share of a frame
+ *
+ * This can be called from any thread between @ref qdspBeginFrame and
+ * @ref qdspEndFrame. It only does arithmetic, so threads don't wait on each
+ * other, and slices that don't overlap can be written at the same time. Every
+ * point in the frame should be written once.
+ *
+ * @param plot The plot being written.
+ * @param offset The index of the first point in the slice.
+ * @param count The number of points in the slice.
+ *
+ * @return Pointers to the slice's coordinates and colors, or NULL pointers if
+ *   no frame is open or the slice runs past its end.
+ */
+QDSPslice qdspFrameSlice(QDSPplot *plot, size_t offset, size_t count);
+
+/** Finishes a frame written with @ref qdspFrameSlice and draws it
+ *
+ * Call this from the thread that called @ref qdspBeginFrame, once every
+ * thread is done writing. It updates the plot as @ref qdspUpdateArrays would.
+ *
+ * @param plot The plot to act on.
+ *
+ * @return 1 if the plot was updated successfully, 2 if the update was dropped
+ *   (see @ref qdspSetOverheadBudget), 0 otherwise.
+ */
+int qdspEndFrame(QDSPplot *plot);
+
 #endif
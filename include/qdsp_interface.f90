@@ -1,22 +1,271 @@
 module qdsp_interface
-!F90 interface module
-!Create pointers to title,x,y,color with c_loc() in iso_c_binding
-!These arrays/strings must be declared with 'target' attribute and must not be allocatable
+!F2008 interface module, with TS 29113 optional arguments for bind(C)
+!Updates take assumed-shape real(4) or real(8) arrays and integer(c_int) colors,
+!and read them in place through their strides, so array sections and components
+!of derived-type arrays (parts%x) are passed without copies
+!Titles and text can be given as Fortran strings
+!The original forms, taking c_ptr arguments from c_loc(), still work
+!Plots from qdspInitThreaded can be used from any thread, and qdspUpdateAsync
+!returns a ticket at once; give the arrays the asynchronous attribute and leave
+!them alone until qdspWaitUpdate has returned for the ticket
+!qdspUpdateFilter takes real(4) or real(8) values and/or integer(c_int) masks to
+!filter on; call qdspUpdateFilterArrays(plot,part_num=0) to remove them
+!Hover and selection callbacks are bind(C) subroutines passed with c_funloc; the
+!point indices they get count from 0
 
+  use iso_c_binding, only: c_ptr,c_char,c_int,c_float,c_double,c_long_long, &
+                           c_intptr_t,c_ptrdiff_t,c_null_ptr,c_null_char, &
+                           c_loc,c_associated,c_f_pointer
   implicit none
-  
-  interface
 
-    type(c_ptr) function qdspInit(title) bind(C,name='qdspInit')
-      use iso_c_binding, only: c_ptr,c_char
+  private :: c_ptr,c_char,c_int,c_float,c_double,c_long_long
+  private :: c_intptr_t,c_ptrdiff_t,c_null_ptr,c_null_char
+  private :: c_loc,c_associated,c_f_pointer
+  private :: describe,describeF64,describeF32,describeInt,updateArrays,cString,c_f_panels
+  private :: qdspUpdateFilterF64,qdspUpdateFilterF32,qdspUpdateFilterMask
+
+  !modes for qdspSetAutoBounds
+  integer(kind=c_int),parameter :: QDSP_AUTO_OFF=0
+  integer(kind=c_int),parameter :: QDSP_AUTO_TIGHT=1
+  integer(kind=c_int),parameter :: QDSP_AUTO_PADDED=2
+  integer(kind=c_int),parameter :: QDSP_AUTO_PERCENTILE=3
+  integer(kind=c_int),parameter :: QDSP_AUTO_EXPAND=4
+
+  !joins for qdspSetLineStyle
+  integer(kind=c_int),parameter :: QDSP_JOIN_MITER=0
+  integer(kind=c_int),parameter :: QDSP_JOIN_ROUND=1
+
+  !modes for qdspSetBlendMode
+  integer(kind=c_int),parameter :: QDSP_BLEND_ALPHA=0
+  integer(kind=c_int),parameter :: QDSP_BLEND_ADD=1
+
+  !attributes for qdspSetFilterRange
+  integer(kind=c_int),parameter :: QDSP_FILTER_X=0
+  integer(kind=c_int),parameter :: QDSP_FILTER_Y=1
+  integer(kind=c_int),parameter :: QDSP_FILTER_VALUE=2
+
+  !element types for QDSParray
+  integer(kind=c_int),parameter :: QDSP_FLOAT64=0
+  integer(kind=c_int),parameter :: QDSP_FLOAT32=1
+  integer(kind=c_int),parameter :: QDSP_INT32=2
+
+  !update modes, matching qdspUpdate, qdspUpdateIfReady and qdspUpdateWait
+  integer,parameter,private :: UPDATE_NOW=0,UPDATE_IF_READY=1,UPDATE_WAIT=2
+
+  type,bind(C) :: QDSParray
+    type(c_ptr) :: data
+    integer(kind=c_int) :: type
+    integer(kind=c_ptrdiff_t) :: stride
+  end type
+
+  !a column of a file for qdspUpdateFile, offset and stride in bytes
+  type,bind(C) :: QDSPcolumn
+    integer(kind=c_long_long) :: offset
+    integer(kind=c_int) :: type
+    integer(kind=c_ptrdiff_t) :: stride
+  end type
+
+  !one thread's share of a frame from qdspFrameSlice; use c_f_pointer to
+  !write through it
+  type,bind(C) :: QDSPslice
+    type(c_ptr) :: x,y,color
+  end type
+
+  type,bind(C) :: QDSPstats
+    real(kind=c_double) :: fps,frameMs,pointsPerSec,bytesPerSec
+    real(kind=c_double) :: gpuGridMs,gpuPointsMs,gpuTextMs
+    integer(kind=c_long_long) :: frames,pointsUploaded,bytesUploaded
+    real(kind=c_double) :: overhead,budgetFps
+    integer(kind=c_int) :: pointStride
+  end type
+
+  interface qdspInit
+    module procedure qdspInitStr
+    type(c_ptr) function qdspInitPtr(title) bind(C,name='qdspInit')
+      use iso_c_binding, only: c_ptr
       type(c_ptr),value,intent(in) :: title
     end function
+  end interface
+
+  interface qdspInitGrid
+    module procedure qdspInitGridStr
+    type(c_ptr) function qdspInitGridPtr(title,rows,cols) bind(C,name='qdspInitGrid')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value,intent(in) :: title
+      integer(kind=c_int),value :: rows,cols
+    end function
+  end interface
+
+  interface qdspInitThreaded
+    module procedure qdspInitThreadedStr
+    type(c_ptr) function qdspInitThreadedPtr(title) bind(C,name='qdspInitThreaded')
+      use iso_c_binding, only: c_ptr
+      type(c_ptr),value,intent(in) :: title
+    end function
+  end interface
+
+  interface qdspInitGridThreaded
+    module procedure qdspInitGridThreadedStr
+    type(c_ptr) function qdspInitGridThreadedPtr(title,rows,cols) bind(C,name='qdspInitGridThreaded')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value,intent(in) :: title
+      integer(kind=c_int),value :: rows,cols
+    end function
+  end interface
+
+  interface qdspUpdateAsync
+    module procedure qdspUpdateAsyncF64,qdspUpdateAsyncF32
+  end interface
 
-    integer(kind=c_int) function qdspUpdateIfReady(plot,x,y,color,part_num) bind(C,name='qdspUpdateIfReady')
+  interface qdspUpdate
+    module procedure qdspUpdateF64,qdspUpdateF32
+    integer(kind=c_int) function qdspUpdatePtr(plot,x,y,color,part_num) bind(C,name='qdspUpdate')
       use iso_c_binding, only: c_ptr,c_int
       type(c_ptr),value :: plot,x,y,color
       integer(kind=c_int),value :: part_num
     end function
+  end interface
+
+  interface qdspUpdateIfReady
+    module procedure qdspUpdateIfReadyF64,qdspUpdateIfReadyF32
+    integer(kind=c_int) function qdspUpdateIfReadyPtr(plot,x,y,color,part_num) bind(C,name='qdspUpdateIfReady')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot,x,y,color
+      integer(kind=c_int),value :: part_num
+    end function
+  end interface
+
+  interface qdspUpdateWait
+    module procedure qdspUpdateWaitF64,qdspUpdateWaitF32
+    integer(kind=c_int) function qdspUpdateWaitPtr(plot,x,y,color,part_num) bind(C,name='qdspUpdateWait')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot,x,y,color
+      integer(kind=c_int),value :: part_num
+    end function
+  end interface
+
+  interface qdspUpdateCurves
+    module procedure qdspUpdateCurvesF64
+    integer(kind=c_int) function qdspUpdateCurvesPtr(plot,x,y,part_num,starts,counts,colors,curve_num) &
+        bind(C,name='qdspUpdateCurves')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot,x,y,starts,counts,colors
+      integer(kind=c_int),value :: part_num,curve_num
+    end function
+  end interface
+
+  interface qdspSetText
+    module procedure qdspSetTextStr
+    subroutine qdspSetTextPtr(plot,slot,x,y,text) bind(C,name='qdspSetText')
+      use iso_c_binding, only: c_ptr,c_int,c_double
+      type(c_ptr),value :: plot,text
+      integer(kind=c_int),value :: slot
+      real(kind=c_double),value :: x,y
+    end subroutine
+  end interface
+
+  interface qdspUpdateFile
+    module procedure qdspUpdateFileStr
+    integer(kind=c_int) function qdspUpdateFilePtr(plot,path,x,y,color,part_num) &
+        bind(C,name='qdspUpdateFile')
+      use iso_c_binding, only: c_ptr,c_int,c_long_long
+      import :: QDSPcolumn
+      type(c_ptr),value :: plot,path
+      type(QDSPcolumn),intent(in) :: x,y
+      type(QDSPcolumn),intent(in),optional :: color
+      integer(kind=c_long_long),value :: part_num
+    end function
+  end interface
+
+  interface
+
+    integer(kind=c_long_long) function qdspUpdateArraysAsync(plot,x,y,color,part_num) &
+        bind(C,name='qdspUpdateArraysAsync')
+      use iso_c_binding, only: c_ptr,c_int,c_long_long
+      import :: QDSParray
+      type(c_ptr),value :: plot
+      type(QDSParray),intent(in) :: x,y
+      type(QDSParray),intent(in),optional :: color
+      integer(kind=c_int),value :: part_num
+    end function
+
+    integer(kind=c_int) function qdspWaitUpdate(plot,ticket) bind(C,name='qdspWaitUpdate')
+      use iso_c_binding, only: c_ptr,c_int,c_long_long
+      type(c_ptr),value :: plot
+      integer(kind=c_long_long),value :: ticket
+    end function
+
+    !either may be absent, to filter on no values or put every point in class 0
+    integer(kind=c_int) function qdspUpdateFilterArrays(plot,values,mask,part_num) &
+        bind(C,name='qdspUpdateFilter')
+      use iso_c_binding, only: c_ptr,c_int
+      import :: QDSParray
+      type(c_ptr),value :: plot
+      type(QDSParray),intent(in),optional :: values,mask
+      integer(kind=c_int),value :: part_num
+    end function
+
+    !color may be absent for the default color
+    integer(kind=c_int) function qdspUpdateArrays(plot,x,y,color,part_num) bind(C,name='qdspUpdateArrays')
+      use iso_c_binding, only: c_ptr,c_int
+      import :: QDSParray
+      type(c_ptr),value :: plot
+      type(QDSParray),intent(in) :: x,y
+      type(QDSParray),intent(in),optional :: color
+      integer(kind=c_int),value :: part_num
+    end function
+
+    integer(kind=c_int) function qdspUpdateArraysLarge(plot,x,y,color,part_num) &
+        bind(C,name='qdspUpdateArraysLarge')
+      use iso_c_binding, only: c_ptr,c_int,c_size_t
+      import :: QDSParray
+      type(c_ptr),value :: plot
+      type(QDSParray),intent(in) :: x,y
+      type(QDSParray),intent(in),optional :: color
+      integer(kind=c_size_t),value :: part_num
+    end function
+
+    integer(kind=c_int) function qdspUpdateArraysIfReady(plot,x,y,color,part_num) &
+        bind(C,name='qdspUpdateArraysIfReady')
+      use iso_c_binding, only: c_ptr,c_int
+      import :: QDSParray
+      type(c_ptr),value :: plot
+      type(QDSParray),intent(in) :: x,y
+      type(QDSParray),intent(in),optional :: color
+      integer(kind=c_int),value :: part_num
+    end function
+
+    integer(kind=c_int) function qdspUpdateArraysWait(plot,x,y,color,part_num) &
+        bind(C,name='qdspUpdateArraysWait')
+      use iso_c_binding, only: c_ptr,c_int
+      import :: QDSParray
+      type(c_ptr),value :: plot
+      type(QDSParray),intent(in) :: x,y
+      type(QDSParray),intent(in),optional :: color
+      integer(kind=c_int),value :: part_num
+    end function
+
+    subroutine qdspDelete(plot) bind(C,name='qdspDelete')
+      use iso_c_binding, only: c_ptr
+      type(c_ptr),value :: plot
+    end subroutine
+
+    subroutine qdspRedraw(plot) bind(C,name='qdspRedraw')
+      use iso_c_binding, only: c_ptr
+      type(c_ptr),value :: plot
+    end subroutine
+
+    integer(kind=c_int) function qdspPoll(plot) bind(C,name='qdspPoll')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+    end function
+
+    subroutine qdspGetStats(plot,stats) bind(C,name='qdspGetStats')
+      use iso_c_binding, only: c_ptr
+      import :: QDSPstats
+      type(c_ptr),value :: plot
+      type(QDSPstats),intent(out) :: stats
+    end subroutine
 
     subroutine qdspSetBounds(plot,xmin,xmax,ymin,ymax) bind(C,name='qdspSetBounds')
       use iso_c_binding, only: c_ptr,c_double
@@ -24,6 +273,75 @@ module qdsp_interface
       real(kind=c_double),value :: xmin,xmax,ymin,ymax
     end subroutine
 
+    subroutine qdspSetAutoBounds(plot,mode) bind(C,name='qdspSetAutoBounds')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: mode
+    end subroutine
+
+    subroutine qdspSetHighPrecision(plot,enabled) bind(C,name='qdspSetHighPrecision')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: enabled
+    end subroutine
+
+    subroutine qdspSetPersistence(plot,decay) bind(C,name='qdspSetPersistence')
+      use iso_c_binding, only: c_ptr,c_double
+      type(c_ptr),value :: plot
+      real(kind=c_double),value :: decay
+    end subroutine
+
+    subroutine qdspSetTrails(plot,length,count) bind(C,name='qdspSetTrails')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: length,count
+    end subroutine
+
+    subroutine qdspSetConnected(plot,connected) bind(C,name='qdspSetConnected')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: connected
+    end subroutine
+
+    subroutine qdspSetSpatialSort(plot,enabled) bind(C,name='qdspSetSpatialSort')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: enabled
+    end subroutine
+
+    subroutine qdspSetBlendMode(plot,mode) bind(C,name='qdspSetBlendMode')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: mode
+    end subroutine
+
+    integer(kind=c_int) function qdspBeginFrame(plot,part_num,has_color) &
+        bind(C,name='qdspBeginFrame')
+      use iso_c_binding, only: c_ptr,c_int,c_size_t
+      type(c_ptr),value :: plot
+      integer(kind=c_size_t),value :: part_num
+      integer(kind=c_int),value :: has_color
+    end function
+
+    type(QDSPslice) function qdspFrameSlice(plot,offset,part_num) bind(C,name='qdspFrameSlice')
+      use iso_c_binding, only: c_ptr,c_size_t
+      import :: QDSPslice
+      type(c_ptr),value :: plot
+      integer(kind=c_size_t),value :: offset,part_num
+    end function
+
+    integer(kind=c_int) function qdspEndFrame(plot) bind(C,name='qdspEndFrame')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+    end function
+
+    subroutine qdspSetLineStyle(plot,width,join) bind(C,name='qdspSetLineStyle')
+      use iso_c_binding, only: c_ptr,c_int,c_double
+      type(c_ptr),value :: plot
+      real(kind=c_double),value :: width
+      integer(kind=c_int),value :: join
+    end subroutine
+
     subroutine qdspSetGridX(plot,point,interval,rgb) bind(C,name='qdspSetGridX')
       use iso_c_binding, only: c_ptr,c_double,c_int
       type(c_ptr),value :: plot
@@ -38,18 +356,344 @@ module qdsp_interface
       integer(kind=c_int),value :: rgb
     end subroutine
 
+    subroutine qdspSetGridVisible(plot,visible) bind(C,name='qdspSetGridVisible')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: visible
+    end subroutine
+
+    subroutine qdspSetFramerate(plot,framerate) bind(C,name='qdspSetFramerate')
+      use iso_c_binding, only: c_ptr,c_double
+      type(c_ptr),value :: plot
+      real(kind=c_double),value :: framerate
+    end subroutine
+
+    subroutine qdspSetOverheadBudget(plot,fraction) bind(C,name='qdspSetOverheadBudget')
+      use iso_c_binding, only: c_ptr,c_double
+      type(c_ptr),value :: plot
+      real(kind=c_double),value :: fraction
+    end subroutine
+
+    subroutine qdspSetHoverCallback(plot,callback,data) bind(C,name='qdspSetHoverCallback')
+      use iso_c_binding, only: c_ptr,c_funptr
+      type(c_ptr),value :: plot
+      type(c_funptr),value :: callback
+      type(c_ptr),value :: data
+    end subroutine
+
+    subroutine qdspSetSelectCallback(plot,callback,data) bind(C,name='qdspSetSelectCallback')
+      use iso_c_binding, only: c_ptr,c_funptr
+      type(c_ptr),value :: plot
+      type(c_funptr),value :: callback
+      type(c_ptr),value :: data
+    end subroutine
+
+    subroutine qdspSetFilterRange(plot,attribute,min,max) bind(C,name='qdspSetFilterRange')
+      use iso_c_binding, only: c_ptr,c_int,c_double
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: attribute
+      real(kind=c_double),value :: min,max
+    end subroutine
+
+    !bit n of classes shows class n
+    subroutine qdspSetFilterClasses(plot,classes) bind(C,name='qdspSetFilterClasses')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: classes
+    end subroutine
+
+    subroutine qdspSetPointAlpha(plot,alpha) bind(C,name='qdspSetPointAlpha')
+      use iso_c_binding, only: c_ptr,c_double
+      type(c_ptr),value :: plot
+      real(kind=c_double),value :: alpha
+    end subroutine
+
     subroutine qdspSetPointColor(plot,rgb) bind(C,name='qdspSetPointColor')
       use iso_c_binding, only: c_ptr,c_int
       type(c_ptr),value :: plot
       integer(kind=c_int),value :: rgb
     end subroutine
 
+    subroutine qdspSetPointSize(plot,pixels) bind(C,name='qdspSetPointSize')
+      use iso_c_binding, only: c_ptr,c_int
+      type(c_ptr),value :: plot
+      integer(kind=c_int),value :: pixels
+    end subroutine
+
     subroutine qdspSetBGColor(plot,rgb) bind(C,name='qdspSetBGColor')
       use iso_c_binding, only: c_ptr,c_int
       type(c_ptr),value :: plot
       integer(kind=c_int),value :: rgb
     end subroutine
 
-  end interface 
+  end interface
+
+  !values, with an optional mask, or just a mask
+  interface qdspUpdateFilter
+    module procedure qdspUpdateFilterF64,qdspUpdateFilterF32,qdspUpdateFilterMask
+  end interface
+
+  !describes an array for the C library without copying it
+  interface describe
+    module procedure describeF64,describeF32,describeInt
+  end interface
+
+contains
+
+  type(c_ptr) function qdspInitStr(title)
+    character(len=*),intent(in) :: title
+    character(kind=c_char),allocatable,target :: str(:)
+    call cString(title,str)
+    qdspInitStr=qdspInitPtr(c_loc(str))
+  end function
+
+  !returns the panels row by row from the top left, or a null pointer if the
+  !window could not be created
+  function qdspInitGridStr(title,rows,cols) result(panels)
+    character(len=*),intent(in) :: title
+    integer(kind=c_int),intent(in) :: rows,cols
+    type(c_ptr),pointer :: panels(:)
+    character(kind=c_char),allocatable,target :: str(:)
+    type(c_ptr) :: grid
+    call cString(title,str)
+    grid=qdspInitGridPtr(c_loc(str),rows,cols)
+    panels=>c_f_panels(grid,rows*cols)
+  end function
+
+  type(c_ptr) function qdspInitThreadedStr(title)
+    character(len=*),intent(in) :: title
+    character(kind=c_char),allocatable,target :: str(:)
+    call cString(title,str)
+    qdspInitThreadedStr=qdspInitThreadedPtr(c_loc(str))
+  end function
+
+  function qdspInitGridThreadedStr(title,rows,cols) result(panels)
+    character(len=*),intent(in) :: title
+    integer(kind=c_int),intent(in) :: rows,cols
+    type(c_ptr),pointer :: panels(:)
+    character(kind=c_char),allocatable,target :: str(:)
+    type(c_ptr) :: grid
+    call cString(title,str)
+    grid=qdspInitGridThreadedPtr(c_loc(str),rows,cols)
+    panels=>c_f_panels(grid,rows*cols)
+  end function
+
+  function c_f_panels(grid,count) result(panels)
+    type(c_ptr),intent(in) :: grid
+    integer,intent(in) :: count
+    type(c_ptr),pointer :: panels(:)
+    nullify(panels)
+    if (c_associated(grid)) call c_f_pointer(grid,panels,[count])
+  end function
+
+  !color may be omitted for the default color
+  integer(kind=c_int) function qdspUpdateFileStr(plot,path,x,y,color,part_num)
+    type(c_ptr),intent(in) :: plot
+    character(len=*),intent(in) :: path
+    type(QDSPcolumn),intent(in) :: x,y
+    type(QDSPcolumn),intent(in),optional :: color
+    integer(kind=c_long_long),intent(in) :: part_num
+    character(kind=c_char),allocatable,target :: str(:)
+    call cString(path,str)
+    qdspUpdateFileStr=qdspUpdateFilePtr(plot,c_loc(str),x,y,color,part_num)
+  end function
+
+  !text may be omitted to remove the annotation
+  subroutine qdspSetTextStr(plot,slot,x,y,text)
+    type(c_ptr),intent(in) :: plot
+    integer(kind=c_int),intent(in) :: slot
+    real(kind=c_double),intent(in) :: x,y
+    character(len=*),intent(in),optional :: text
+    character(kind=c_char),allocatable,target :: str(:)
+    if (present(text)) then
+      call cString(text,str)
+      call qdspSetTextPtr(plot,slot,x,y,c_loc(str))
+    else
+      call qdspSetTextPtr(plot,slot,x,y,c_null_ptr)
+    end if
+  end subroutine
+
+  integer(kind=c_int) function qdspUpdateF64(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_double),intent(in),target :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,optional :: color(:)
+    qdspUpdateF64=updateArrays(plot,describe(x),describe(y),min(size(x),size(y)),color,UPDATE_NOW)
+  end function
+
+  integer(kind=c_int) function qdspUpdateF32(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_float),intent(in),target :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,optional :: color(:)
+    qdspUpdateF32=updateArrays(plot,describe(x),describe(y),min(size(x),size(y)),color,UPDATE_NOW)
+  end function
+
+  integer(kind=c_int) function qdspUpdateIfReadyF64(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_double),intent(in),target :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,optional :: color(:)
+    qdspUpdateIfReadyF64=updateArrays(plot,describe(x),describe(y),min(size(x),size(y)),color,UPDATE_IF_READY)
+  end function
+
+  integer(kind=c_int) function qdspUpdateIfReadyF32(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_float),intent(in),target :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,optional :: color(:)
+    qdspUpdateIfReadyF32=updateArrays(plot,describe(x),describe(y),min(size(x),size(y)),color,UPDATE_IF_READY)
+  end function
+
+  integer(kind=c_int) function qdspUpdateWaitF64(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_double),intent(in),target :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,optional :: color(:)
+    qdspUpdateWaitF64=updateArrays(plot,describe(x),describe(y),min(size(x),size(y)),color,UPDATE_WAIT)
+  end function
+
+  integer(kind=c_int) function qdspUpdateWaitF32(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_float),intent(in),target :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,optional :: color(:)
+    qdspUpdateWaitF32=updateArrays(plot,describe(x),describe(y),min(size(x),size(y)),color,UPDATE_WAIT)
+  end function
+
+  !returns a ticket for qdspWaitUpdate; the arrays are read after this returns
+  integer(kind=c_long_long) function qdspUpdateAsyncF64(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_double),intent(in),target,asynchronous :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,asynchronous,optional :: color(:)
+    integer(kind=c_int) :: n
+    n=min(size(x),size(y))
+    if (present(color)) then
+      qdspUpdateAsyncF64=qdspUpdateArraysAsync(plot,describe(x),describe(y),describe(color),min(n,size(color)))
+    else
+      qdspUpdateAsyncF64=qdspUpdateArraysAsync(plot,describe(x),describe(y),part_num=n)
+    end if
+  end function
+
+  integer(kind=c_long_long) function qdspUpdateAsyncF32(plot,x,y,color)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_float),intent(in),target,asynchronous :: x(:),y(:)
+    integer(kind=c_int),intent(in),target,asynchronous,optional :: color(:)
+    integer(kind=c_int) :: n
+    n=min(size(x),size(y))
+    if (present(color)) then
+      qdspUpdateAsyncF32=qdspUpdateArraysAsync(plot,describe(x),describe(y),describe(color),min(n,size(color)))
+    else
+      qdspUpdateAsyncF32=qdspUpdateArraysAsync(plot,describe(x),describe(y),part_num=n)
+    end if
+  end function
+
+  !curves are drawn straight from the caller's arrays, so the coordinates are
+  !contiguous; starts are offsets into x and y, counting from 0 as in C
+  integer(kind=c_int) function qdspUpdateCurvesF64(plot,x,y,starts,counts,colors)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_double),intent(in),contiguous,target :: x(:),y(:)
+    integer(kind=c_int),intent(in),contiguous,target :: starts(:),counts(:)
+    integer(kind=c_int),intent(in),contiguous,target,optional :: colors(:)
+    type(c_ptr) :: colorPtr
+    integer :: numCurves
+    numCurves=min(size(starts),size(counts))
+    colorPtr=c_null_ptr
+    if (present(colors)) then
+      numCurves=min(numCurves,size(colors))
+      if (size(colors)>0) colorPtr=c_loc(colors)
+    end if
+    qdspUpdateCurvesF64=0
+    if (size(x)==0 .or. size(y)==0 .or. numCurves==0) return
+    qdspUpdateCurvesF64=qdspUpdateCurvesPtr(plot,c_loc(x),c_loc(y),min(size(x),size(y)), &
+                                            c_loc(starts),c_loc(counts),colorPtr,numCurves)
+  end function
+
+  integer(kind=c_int) function qdspUpdateFilterF64(plot,values,mask)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_double),intent(in),target :: values(:)
+    integer(kind=c_int),intent(in),target,optional :: mask(:)
+    if (present(mask)) then
+      qdspUpdateFilterF64=qdspUpdateFilterArrays(plot,describe(values),describe(mask), &
+                                                 min(size(values),size(mask)))
+    else
+      qdspUpdateFilterF64=qdspUpdateFilterArrays(plot,describe(values),part_num=size(values))
+    end if
+  end function
+
+  integer(kind=c_int) function qdspUpdateFilterF32(plot,values,mask)
+    type(c_ptr),intent(in) :: plot
+    real(kind=c_float),intent(in),target :: values(:)
+    integer(kind=c_int),intent(in),target,optional :: mask(:)
+    if (present(mask)) then
+      qdspUpdateFilterF32=qdspUpdateFilterArrays(plot,describe(values),describe(mask), &
+                                                 min(size(values),size(mask)))
+    else
+      qdspUpdateFilterF32=qdspUpdateFilterArrays(plot,describe(values),part_num=size(values))
+    end if
+  end function
+
+  integer(kind=c_int) function qdspUpdateFilterMask(plot,mask)
+    type(c_ptr),intent(in) :: plot
+    integer(kind=c_int),intent(in),target :: mask(:)
+    qdspUpdateFilterMask=qdspUpdateFilterArrays(plot,mask=describe(mask),part_num=size(mask))
+  end function
+
+  integer(kind=c_int) function updateArrays(plot,x,y,numPoints,color,mode)
+    type(c_ptr),intent(in) :: plot
+    type(QDSParray),intent(in) :: x,y
+    integer,intent(in) :: numPoints,mode
+    integer(kind=c_int),intent(in),target,optional :: color(:)
+    integer(kind=c_int) :: n
+    n=numPoints
+    if (present(color)) then
+      n=min(n,size(color))
+      select case (mode)
+      case (UPDATE_IF_READY)
+        updateArrays=qdspUpdateArraysIfReady(plot,x,y,describe(color),n)
+      case (UPDATE_WAIT)
+        updateArrays=qdspUpdateArraysWait(plot,x,y,describe(color),n)
+      case default
+        updateArrays=qdspUpdateArrays(plot,x,y,describe(color),n)
+      end select
+    else
+      select case (mode)
+      case (UPDATE_IF_READY)
+        updateArrays=qdspUpdateArraysIfReady(plot,x,y,part_num=n)
+      case (UPDATE_WAIT)
+        updateArrays=qdspUpdateArraysWait(plot,x,y,part_num=n)
+      case default
+        updateArrays=qdspUpdateArrays(plot,x,y,part_num=n)
+      end select
+    end if
+  end function
+
+  !the stride comes from the addresses of the first two elements, which is where
+  !the array descriptor puts them; a stride of 0 means packed
+  type(QDSParray) function describeF64(x) result(arr)
+    real(kind=c_double),intent(in),target :: x(:)
+    arr=QDSParray(c_null_ptr,QDSP_FLOAT64,0)
+    if (size(x)>0) arr%data=c_loc(x(1))
+    if (size(x)>1) arr%stride=transfer(c_loc(x(2)),0_c_intptr_t)-transfer(c_loc(x(1)),0_c_intptr_t)
+  end function
+
+  type(QDSParray) function describeF32(x) result(arr)
+    real(kind=c_float),intent(in),target :: x(:)
+    arr=QDSParray(c_null_ptr,QDSP_FLOAT32,0)
+    if (size(x)>0) arr%data=c_loc(x(1))
+    if (size(x)>1) arr%stride=transfer(c_loc(x(2)),0_c_intptr_t)-transfer(c_loc(x(1)),0_c_intptr_t)
+  end function
+
+  type(QDSParray) function describeInt(x) result(arr)
+    integer(kind=c_int),intent(in),target :: x(:)
+    arr=QDSParray(c_null_ptr,QDSP_INT32,0)
+    if (size(x)>0) arr%data=c_loc(x(1))
+    if (size(x)>1) arr%stride=transfer(c_loc(x(2)),0_c_intptr_t)-transfer(c_loc(x(1)),0_c_intptr_t)
+  end function
+
+  subroutine cString(text,str)
+    character(len=*),intent(in) :: text
+    character(kind=c_char),allocatable,intent(out) :: str(:)
+    integer :: i
+    allocate(str(len(text)+1))
+    do i=1,len(text)
+      str(i)=text(i:i)
+    end do
+    str(len(text)+1)=c_null_char
+  end subroutine
 
 end module
@@ -1,4 +1,8 @@
 #!/usr/bin/python3
 
-from .qdsp import QDSPplot
+from .qdsp import QDSPplot, QDSPstats, initGrid
+from .qdsp import AUTO_OFF, AUTO_TIGHT, AUTO_PADDED, AUTO_PERCENTILE, AUTO_EXPAND
+from .qdsp import JOIN_MITER, JOIN_ROUND
+from .qdsp import BLEND_ALPHA, BLEND_ADD
 QDSPplot.__module__ = 'qdsp'
+QDSPstats.__module__ = 'qdsp'
@@ -0,0 +1,246 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <limits.h>
+
+#include <qdsp.h>
+
+// Native update calls for the Python bindings. Coordinates and colors are read
+// in place from anything with the buffer protocol (numpy arrays, strided views,
+// fields of structured arrays), and the GIL is released while the data is
+// uploaded and drawn.
+//
+// Background plots are threaded plots from qdspInitThreaded. Their frames are
+// queued with submit, which returns at once with the buffers still locked, and
+// wait blocks (without the GIL) until the render thread has read them.
+
+// matching QDSPplot.update, updateIfReady and updateWait
+#define UPDATE_NOW 0
+#define UPDATE_IF_READY 1
+#define UPDATE_WAIT 2
+
+// skips a byte order prefix, if it's native
+static const char *nativeFormat(const char *format) {
+	int little = (*(const char*)&(int){1} == 1);
+	if (*format == '@' || *format == '=' || (*format == '<' && little)
+	    || ((*format == '>' || *format == '!') && !little))
+		return format + 1;
+	return format;
+}
+
+// fills arr from a one-dimensional buffer, which has to be released afterwards
+static int getArray(PyObject *obj, Py_buffer *view, QDSParray *arr, int color) {
+	if (PyObject_GetBuffer(obj, view, PyBUF_STRIDES | PyBUF_FORMAT) < 0)
+		return 0;
+
+	if (view->ndim != 1) {
+		PyErr_SetString(PyExc_ValueError, "arrays must be one-dimensional");
+		PyBuffer_Release(view);
+		return 0;
+	}
+
+	const char *format = nativeFormat(view->format);
+	int ok = 0;
+	if (color && view->itemsize == 4 && format[1] == '\0') {
+		ok = (strchr("iIlL", format[0]) != NULL);
+		arr->type = QDSP_INT32;
+	} else if (!color && format[0] == 'd' && format[1] == '\0') {
+		ok = (view->itemsize == 8);
+		arr->type = QDSP_FLOAT64;
+	} else if (!color && format[0] == 'f' && format[1] == '\0') {
+		ok = (view->itemsize == 4);
+		arr->type = QDSP_FLOAT32;
+	}
+
+	if (!ok) {
+		PyErr_Format(PyExc_TypeError, "unsupported %s array format '%s'",
+		             color ? "color" : "coordinate", view->format);
+		PyBuffer_Release(view);
+		return 0;
+	}
+
+	arr->data = view->buf;
+	arr->stride = view->strides[0];
+	return 1;
+}
+
+static void releaseArrays(Py_buffer *views, int numViews) {
+	for (int i = 0; i < numViews; i++)
+		PyBuffer_Release(&views[i]);
+}
+
+// fills views and arrs from x, y, and colors (which may be None), and size
+// with the number of points; returns the number of views to release, or 0
+static int getArrays(PyObject *objs[3], Py_buffer views[3], QDSParray arrs[3],
+                     Py_ssize_t *size) {
+	int numViews = (objs[2] != Py_None) ? 3 : 2;
+	for (int i = 0; i < numViews; i++) {
+		if (!getArray(objs[i], &views[i], &arrs[i], i == 2)) {
+			releaseArrays(views, i);
+			return 0;
+		}
+	}
+
+	// if colors are given, they can't be too short
+	*size = views[0].shape[0];
+	for (int i = 1; i < numViews; i++) {
+		if (views[i].shape[0] < *size)
+			*size = views[i].shape[0];
+	}
+	return numViews;
+}
+
+static QDSPplot *getPlot(PyObject *plotObj) {
+	QDSPplot *plot = PyLong_AsVoidPtr(plotObj);
+	if (plot == NULL && !PyErr_Occurred())
+		PyErr_SetString(PyExc_ValueError, "plot is NULL");
+	return plot;
+}
+
+static PyObject *update(PyObject *self, PyObject *args) {
+	(void)self;
+	PyObject *plotObj, *objs[3];
+	int mode;
+	if (!PyArg_ParseTuple(args, "OOOOi", &plotObj, &objs[0], &objs[1], &objs[2], &mode))
+		return NULL;
+
+	QDSPplot *plot = getPlot(plotObj);
+	if (plot == NULL)
+		return NULL;
+
+	Py_buffer views[3];
+	QDSParray arrs[3];
+	Py_ssize_t size;
+	int numViews = getArrays(objs, views, arrs, &size);
+	if (numViews == 0)
+		return NULL;
+
+	// only plain updates take more than an int's worth
+	int ret = 0;
+	if (size > INT_MAX && mode != UPDATE_NOW) {
+		PyErr_SetString(PyExc_OverflowError, "too many points");
+	} else {
+		// the buffers stay locked, so numpy can't free or resize them while
+		// we're reading them
+		Py_BEGIN_ALLOW_THREADS
+		const QDSParray *c = (numViews == 3) ? &arrs[2] : NULL;
+		if (mode == UPDATE_IF_READY)
+			ret = qdspUpdateArraysIfReady(plot, &arrs[0], &arrs[1], c, size);
+		else if (mode == UPDATE_WAIT)
+			ret = qdspUpdateArraysWait(plot, &arrs[0], &arrs[1], c, size);
+		else
+			ret = qdspUpdateArraysLarge(plot, &arrs[0], &arrs[1], c, size);
+		Py_END_ALLOW_THREADS
+	}
+
+	releaseArrays(views, numViews);
+
+	if (PyErr_Occurred())
+		return NULL;
+	return PyLong_FromLong(ret);
+}
+
+// a frame queued by submit, whose buffers stay locked until it's been read
+typedef struct {
+	QDSPplot *plot;
+	long long ticket;
+	Py_buffer views[3];
+	int numViews; // 0 once waited for
+	int result;
+} Pending;
+
+#define PENDING_NAME "qdsp._qdsp.Pending"
+
+// waits for the render thread to read the frame, and unlocks its buffers
+static int waitPending(Pending *pending) {
+	if (pending->numViews == 0)
+		return pending->result;
+
+	// the render thread may need the GIL for a hover or select callback
+	Py_BEGIN_ALLOW_THREADS
+	pending->result = qdspWaitUpdate(pending->plot, pending->ticket);
+	Py_END_ALLOW_THREADS
+
+	releaseArrays(pending->views, pending->numViews);
+	pending->numViews = 0;
+	return pending->result;
+}
+
+// a frame that's dropped unwaited is still being read
+static void freePending(PyObject *capsule) {
+	Pending *pending = PyCapsule_GetPointer(capsule, PENDING_NAME);
+	waitPending(pending);
+	PyMem_Free(pending);
+}
+
+static PyObject *submitFrame(PyObject *self, PyObject *args) {
+	(void)self;
+	PyObject *plotObj, *objs[3];
+	if (!PyArg_ParseTuple(args, "OOOO", &plotObj, &objs[0], &objs[1], &objs[2]))
+		return NULL;
+
+	QDSPplot *plot = getPlot(plotObj);
+	if (plot == NULL)
+		return NULL;
+
+	Pending *pending = PyMem_Malloc(sizeof(Pending));
+	if (pending == NULL)
+		return PyErr_NoMemory();
+	pending->plot = plot;
+
+	QDSParray arrs[3];
+	Py_ssize_t size;
+	int numViews = getArrays(objs, pending->views, arrs, &size);
+	if (numViews == 0) {
+		PyMem_Free(pending);
+		return NULL;
+	}
+	if (size > INT_MAX) {
+		PyErr_SetString(PyExc_OverflowError, "too many points");
+		releaseArrays(pending->views, numViews);
+		PyMem_Free(pending);
+		return NULL;
+	}
+
+	Py_BEGIN_ALLOW_THREADS
+	pending->ticket = qdspUpdateArraysAsync(plot, &arrs[0], &arrs[1],
+	                                        (numViews == 3) ? &arrs[2] : NULL, size);
+	Py_END_ALLOW_THREADS
+	pending->numViews = numViews;
+
+	PyObject *capsule = PyCapsule_New(pending, PENDING_NAME, freePending);
+	if (capsule == NULL) {
+		waitPending(pending);
+		PyMem_Free(pending);
+	}
+	return capsule;
+}
+
+static PyObject *waitFrame(PyObject *self, PyObject *arg) {
+	(void)self;
+	Pending *pending = PyCapsule_GetPointer(arg, PENDING_NAME);
+	if (pending == NULL)
+		return NULL;
+	return PyLong_FromLong(waitPending(pending));
+}
+
+static PyMethodDef methods[] = {
+	{"update", update, METH_VARARGS,
+	 "update(plot, x, y, colors, mode) -> int\n\n"
+	 "Updates a plot from buffers, without copying or holding the GIL."},
+	{"submit", submitFrame, METH_VARARGS,
+	 "submit(plot, x, y, colors) -> pending\n\n"
+	 "Queues a frame for a threaded plot, keeping the buffers locked."},
+	{"wait", waitFrame, METH_O,
+	 "wait(pending) -> int\n\n"
+	 "Waits until a queued frame has been read, then unlocks its buffers."},
+	{NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef module = {
+	PyModuleDef_HEAD_INIT, "_qdsp", "Native update calls for QDSP.", -1, methods,
+	NULL, NULL, NULL, NULL
+};
+
+PyMODINIT_FUNC PyInit__qdsp(void) {
+	return PyModule_Create(&module);
+}
@@ -3,38 +3,269 @@
 
 """
 
+import atexit
+import threading
 import numpy as np
+from collections import deque
+from concurrent.futures import Future
 from ctypes import *
 
+from . import _qdsp
+
 try:
 	lib = cdll.LoadLibrary('libqdsp.so')
 except OSError:
 	print('ERROR: could not load libqdsp.so')
 
+# modes for QDSPplot.setAutoBounds
+AUTO_OFF = 0
+AUTO_TIGHT = 1
+AUTO_PADDED = 2
+AUTO_PERCENTILE = 3
+AUTO_EXPAND = 4
+
+# joins for QDSPplot.setLineStyle
+JOIN_MITER = 0
+JOIN_ROUND = 1
+
+# blend modes for QDSPplot.setBlendMode
+BLEND_ALPHA = 0
+BLEND_ADD = 1
+
+# callbacks for QDSPplot.setHoverCallback and QDSPplot.setSelectCallback
+_HOVER_CALLBACK = CFUNCTYPE(None, c_void_p, c_int, c_void_p)
+_SELECT_CALLBACK = CFUNCTYPE(None, c_void_p, POINTER(c_int), c_int, c_void_p)
+
+# attributes for QDSPplot.setFilterRange
+FILTER_X = 0
+FILTER_Y = 1
+FILTER_VALUE = 2
+
+# types the extension reads in place, anything else is converted to the first
+_COORD_TYPES = (np.float64, np.float32)
+_COLOR_TYPES = (np.int32, np.uint32)
+
+def _asArray(vals, types):
+	if isinstance(vals, np.ndarray) and vals.ndim == 1 and vals.dtype in types:
+		return vals
+	return np.asarray(vals, dtype=types[0])
+
+# runs a call for a background plot, which the C library passes on to its
+# render thread, and returns its result as a finished future
+def _finished(fn, *args):
+	future = Future()
+	try:
+		future.set_result(fn(*args))
+	except Exception as e:
+		future.set_exception(e)
+	return future
+
+# a background plot's frames. Each is queued on the render thread without
+# waiting, and a waiter thread resolves its future once the frame has been
+# read, in the order they were queued. A frame from updateIfReady that comes
+# while another is still being read is held back until that one's done; if
+# a newer frame comes first, it replaces the held one, which resolves to 2
+class _Frames:
+	def __init__(self, ptr):
+		self.ptr = ptr
+		self.lock = threading.Condition()
+		self.queued = deque()
+		self.held = None
+		self.closed = False
+		self.waiter = threading.Thread(target=self.__wait, daemon=True)
+		self.waiter.start()
+
+	def submit(self, x, y, c, ifReady):
+		future = Future()
+		with self.lock:
+			if self.held is not None:
+				self.held[3].set_result(2)
+				self.held = None
+			if ifReady and self.queued:
+				self.held = (x, y, c, future)
+			else:
+				self.__queue(x, y, c, future)
+		return future
+
+	# waits for the queued frames, then stops the waiter
+	def close(self):
+		with self.lock:
+			self.closed = True
+			self.lock.notify()
+		self.waiter.join()
+
+	def __queue(self, x, y, c, future):
+		try:
+			self.queued.append((_qdsp.submit(self.ptr, x, y, c), future))
+			self.lock.notify()
+		except Exception as e:
+			future.set_exception(e)
+
+	def __wait(self):
+		while True:
+			with self.lock:
+				while not self.queued and not self.closed:
+					self.lock.wait()
+				if not self.queued:
+					return
+				pending, future = self.queued[0]
+
+			result = _qdsp.wait(pending)
+
+			with self.lock:
+				self.queued.popleft()
+				if not self.queued and self.held is not None:
+					self.__queue(*self.held)
+					self.held = None
+			future.set_result(result)
+
+# background plots that haven't been deleted; deleting one shuts down the
+# render thread and deletes them all
+_background = []
+
+def _deleteBackground():
+	if _background:
+		_background[0].delete()
+
+atexit.register(_deleteBackground)
+
+# an array in place, for the C library
+class _QDSParray(Structure):
+	_fields_ = [('data', c_void_p),
+	            ('type', c_int),
+	            ('stride', c_ssize_t)]
+
+def _describe(arr):
+	kind = {np.float64: 0, np.float32: 1}.get(arr.dtype.type, 2)
+	return _QDSParray(arr.ctypes.data, kind, arr.strides[0])
+
+# a column of a file, for QDSPplot.updateFile
+class _QDSPcolumn(Structure):
+	_fields_ = [('offset', c_longlong),
+	            ('type', c_int),
+	            ('stride', c_ssize_t)]
+
+def _column(spec):
+	offset, dtype = spec[0], np.dtype(spec[1]).type
+	stride = spec[2] if len(spec) > 2 else 0
+	kind = {np.float64: 0, np.float32: 1, np.int32: 2}.get(dtype)
+	if kind is None:
+		raise TypeError('unsupported column type')
+	return _QDSPcolumn(offset, kind, stride)
+
+class QDSPstats(Structure):
+	"""Performance statistics for a plot, mirroring the QDSPstats C struct.
+
+	Rates are averaged over a short window and GPU times lag the current
+	frame slightly.
+
+	"""
+	_fields_ = [('fps', c_double),
+	            ('frameMs', c_double),
+	            ('pointsPerSec', c_double),
+	            ('bytesPerSec', c_double),
+	            ('gpuGridMs', c_double),
+	            ('gpuPointsMs', c_double),
+	            ('gpuTextMs', c_double),
+	            ('frames', c_longlong),
+	            ('pointsUploaded', c_longlong),
+	            ('bytesUploaded', c_longlong),
+	            ('overhead', c_double),
+	            ('budgetFps', c_double),
+	            ('pointStride', c_int)]
+
+def initGrid(title, rows, cols):
+	"""Creates a window divided into a grid of plots
+	
+	Each panel has its own bounds, grid, settings and data. The window is
+	redrawn, with one buffer swap, once every panel has been updated, or
+	when a panel is updated a second time before that.
+	
+	:param title: The window title.
+	:param rows: The number of rows of panels.
+	:param cols: The number of columns of panels.
+	:returns: A list of :class:`QDSPplot` objects, row by row from the top
+	          left, or None if the window could not be created.
+
+	"""
+	lib.qdspInitGrid.restype = POINTER(c_void_p)
+	panels = lib.qdspInitGrid(title.encode('utf-8'), rows, cols)
+	if not panels:
+		return None
+
+	plots = []
+	for i in range(rows * cols):
+		plot = QDSPplot.__new__(QDSPplot)
+		plot.ptr = panels[i]
+		plot.background = False
+		plots.append(plot)
+	return plots
+
 class QDSPplot:
 	"""This class represents a plot in QDSP, acting as a wrapper for the
 	underlying QDSPplot C struct.
 
 	In order to see a list of plot hotkeys, press 'h' while the plot is running.
 
+	A background plot is a threaded plot (see qdspInitThreaded in the C
+	API), owned by the library's render thread, which keeps handling events
+	and redrawing the window while Python is busy. Its methods pass their
+	work to that thread and return a concurrent.futures.Future, resolving
+	to what the method would have returned. Updates return at once, and
+	the render thread reads the arrays later, so they mustn't be modified
+	until the future is done; it resolves to 1 once they've been read, or
+	0 if the window was closed. Updates are drawn as soon as they're read,
+	so the framerate doesn't hold them back, and updateWait is the same as
+	update. updateIfReady keeps frames from piling up: one that comes while
+	an earlier frame is still being read waits for it, and if a newer frame
+	comes first, it's dropped, resolving to 2. Background plots need a platform where windows can be handled off the main thread,
+	such as Linux, and shouldn't be mixed with other plots in the same
+	process.
+
 	"""
 	
-	def __init__(self, title):
+	def __init__(self, title, background=False):
 		"""
 		
 		:param title: The window title.
+		:param background: True to create the plot on the render thread.
 
 		"""
-		lib.qdspInit.restype = c_void_p
-		self.ptr = lib.qdspInit(title.encode('utf-8'))
+		self.background = background
+		if background:
+			lib.qdspInitThreaded.restype = c_void_p
+			self.ptr = lib.qdspInitThreaded(title.encode('utf-8'))
+			if self.ptr is not None:
+				self.__frames = _Frames(self.ptr)
+				_background.append(self)
+		else:
+			lib.qdspInit.restype = c_void_p
+			self.ptr = lib.qdspInit(title.encode('utf-8'))
+
+	# runs fn(plot, *args), which a background plot's render thread carries
+	# out; the pointer is wrapped, since plain ints are passed to C as 32 bits
+	def __call(self, fn, *args):
+		ptr = c_void_p(self.ptr)
+		if not self.background:
+			return fn(ptr, *args)
+		return _finished(fn, ptr, *args)
 
 	def delete(self):
 		"""Destroys a plot.
 		
-		The plot object is freed and all resources are deleted.
+		The plot object is freed and all resources are deleted. Panels from
+		:func:`initGrid` share a window, so deleting any of them deletes them
+		all. A background plot is deleted once its queued work is done,
+		and deleting one deletes every background plot.
 
 		"""
-		lib.qdspDelete(self.ptr)
+		if not self.background:
+			lib.qdspDelete(c_void_p(self.ptr))
+		elif self in _background:
+			for plot in _background:
+				plot.__frames.close()
+			lib.qdspDelete(c_void_p(self.ptr))
+			_background.clear()
 
 	def redraw(self):
 		"""Redraws a plot.
@@ -43,8 +274,23 @@ class QDSPplot:
 		framerate.
 
 		"""
-		lib.qdspRedraw(self.ptr)
+		return self.__call(lib.qdspRedraw)
 		
+	def getStats(self):
+		"""Gets performance statistics for a plot
+		
+		The same numbers are shown by the on-screen HUD, which can be
+		toggled by pressing 's'.
+		
+		:returns: A QDSPstats object.
+
+		"""
+		stats = QDSPstats()
+		ret = self.__call(lib.qdspGetStats, byref(stats))
+		if self.background:
+			ret.result()
+		return stats
+
 	def setBGColor(self, rgb):
 		"""Sets the background color
 		
@@ -53,7 +299,7 @@ class QDSPplot:
 		:param rgb: The background color, as an integer corresponding to a
 		            hexadecimal RGB triplet.
 		"""
-		lib.qdspSetBGColor(self.ptr, rgb)
+		return self.__call(lib.qdspSetBGColor, rgb)
 		
 	def setBounds(self, xmin, xmax, ymin, ymax):
 		"""Sets the x and y bounds of a plot
@@ -67,8 +313,88 @@ class QDSPplot:
 		:param yMax: The y coordinate of the plot's upper boundary.
 
 		"""
-		lib.qdspSetBounds(self.ptr, c_double(xmin), c_double(xmax),
-		                  c_double(ymin), c_double(ymax))
+		return self.__call(lib.qdspSetBounds, c_double(xmin), c_double(xmax),
+		                   c_double(ymin), c_double(ymax))
+
+	def setAutoBounds(self, mode):
+		"""Fits the plot bounds to the data automatically
+		
+		QDSP computes the bounds of the plot from the data passed to each
+		update, with a parallel reduction done while copying the data to
+		the GPU. Small changes in the fitted bounds are ignored to avoid
+		jitter.
+		
+		:param mode: One of AUTO_OFF (the default), AUTO_TIGHT, AUTO_PADDED
+		             (5% margins), AUTO_PERCENTILE (0.5th to 99.5th
+		             percentiles), or AUTO_EXPAND (grow to fit, only shrink
+		             when the data is much smaller).
+
+		"""
+		return self.__call(lib.qdspSetAutoBounds, mode)
+
+	def setHighPrecision(self, enabled):
+		"""Enables camera-relative, high precision coordinates
+		
+		QDSP subtracts a double precision origin near the view from each
+		point while copying it to the GPU, and sends the offsets as floats.
+		This keeps small views far from the origin sharp, and halves the
+		upload size. The origin only moves during updates.
+		
+		:param enabled: Nonzero to enable high precision mode, zero to
+		                disable it (the default).
+
+		"""
+		return self.__call(lib.qdspSetHighPrecision, enabled)
+
+	def setText(self, slot, x, y, text):
+		"""Sets a text annotation
+		
+		Places a line of text, such as the current time step, in the plot
+		window. Setting a slot again replaces its text, so it's cheap to call
+		every frame. Newlines start a new line below the first.
+		
+		:param slot: The annotation to set, from 0 to 15.
+		:param x: The horizontal position of the start of the text, as a
+		          fraction of the window width from the left edge.
+		:param y: The vertical position of the bottom of the first line, as
+		          a fraction of the window height from the bottom edge.
+		:param text: The text to show, or None to remove the annotation.
+
+		"""
+		return self.__call(lib.qdspSetText, slot, c_double(x), c_double(y),
+		                   None if text is None else text.encode('ascii', 'replace'))
+
+	def setPersistence(self, decay):
+		"""Leaves fading trails behind the points
+		
+		Points are drawn into an offscreen buffer that is faded by the
+		given factor every frame, so earlier positions stay visible as faint
+		trails, at a fixed cost per frame. The buffer is cleared when the
+		bounds change.
+		
+		:param decay: The fraction of brightness kept from one frame to the
+		              next, from 0 to 1. 0 disables persistence (the
+		              default).
+
+		"""
+		return self.__call(lib.qdspSetPersistence, c_double(decay))
+
+	def setTrails(self, length, count):
+		"""Draws the recent path of each particle
+		
+		The positions of the first count points from each of the last
+		length updates are kept on the GPU, and each of those points is
+		drawn with a line through its past positions, fading out with age.
+		Put the particles to follow at the start of the arrays, in the same
+		order every update.
+		
+		:param length: The number of past positions to keep for each
+		               particle. Less than 2 disables trails (the default).
+		:param count: The number of points, from the start of the arrays,
+		              to draw trails for.
+
+		"""
+		return self.__call(lib.qdspSetTrails, length, count)
 
 	def setConnected(self, connected):
 		"""Specifies whether to connect the plot points
@@ -82,8 +408,48 @@ class QDSPplot:
 		                  if they should be connected.
 
 		"""
-		lib.qdspSetConnected(self.ptr, connected)
+		return self.__call(lib.qdspSetConnected, connected)
 		
+	def setLineStyle(self, width, join=JOIN_MITER):
+		"""Sets the width and joins of connected lines
+		
+		Lines are drawn on the GPU straight from the uploaded points, with
+		antialiasing. The default is a 1 pixel line with miter joins.
+		
+		:param width: The line width, in pixels.
+		:param join: JOIN_MITER (sharp corners) or JOIN_ROUND.
+
+		"""
+		return self.__call(lib.qdspSetLineStyle, c_double(width), join)
+
+	def setSpatialSort(self, enabled):
+		"""Specifies whether to sort points by where they land on screen
+		
+		Points are uploaded in the Morton order of the screen tiles they
+		fall in, which helps fill-rate bound GPUs with millions of points.
+		The order is reused while the points barely move. Where points of
+		different colors overlap, a different one may end up on top. Sorting
+		is skipped for connected points, curves, trails, hover and select
+		callbacks, filter data, and while a selection is highlighted.
+		
+		:param enabled: Nonzero to sort points, zero to draw them in order.
+
+		"""
+		return self.__call(lib.qdspSetSpatialSort, enabled)
+
+	def setBlendMode(self, mode):
+		"""Sets how overlapping points are blended
+		
+		With BLEND_ALPHA, the default, each point is drawn over the ones
+		before it. With BLEND_ADD, point colors scaled by the point alpha
+		add up to full brightness, so the result doesn't depend on the order
+		points are drawn in, and dense regions show up brighter.
+		
+		:param mode: BLEND_ALPHA or BLEND_ADD.
+
+		"""
+		return self.__call(lib.qdspSetBlendMode, mode)
+
 	def setGridX(self, point, interval, rgb):
 		"""Sets the locations of x gridlines
 		
@@ -100,7 +466,7 @@ class QDSPplot:
 
 		"""
 		
-		lib.qdspSetGridX(self.ptr, c_double(point), c_double(interval), rgb)
+		return self.__call(lib.qdspSetGridX, c_double(point), c_double(interval), rgb)
 		
 	def setGridY(self, point, interval, rgb):
 		"""Sets the locations of y gridlines
@@ -117,7 +483,18 @@ class QDSPplot:
 		            hexadecimal RGB triplet.
 
 		"""
-		lib.qdspSetGridY(self.ptr, c_double(point), c_double(interval), rgb)
+		return self.__call(lib.qdspSetGridY, c_double(point), c_double(interval), rgb)
+
+	def setGridVisible(self, visible):
+		"""Shows or hides the gridlines
+		
+		Gridlines are hidden by default, and can also be toggled by pressing
+		'g'.
+		
+		:param visible: True to show the gridlines, False to hide them.
+
+		"""
+		return self.__call(lib.qdspSetGridVisible, visible)
 		
 	def setFramerate(self, framerate):
 		"""Caps the update framerate of a plot
@@ -131,7 +508,95 @@ class QDSPplot:
 		:param framerate: The framerate, in frames per second.
 
 		"""
-		lib.qdspRedraw(self.ptr, c_double(framerate))
+		return self.__call(lib.qdspSetFramerate, c_double(framerate))
+
+	def setOverheadBudget(self, fraction):
+		"""Limits plotting to a fraction of the application's time
+		
+		Updates are timed against the time spent between them, and updates
+		that come too soon are dropped so plotting takes at most the given
+		fraction of the total. Below 10 FPS, only every nth point is
+		uploaded instead. The decisions are reported by @ref getStats.
+		
+		:param fraction: The fraction of time, between 0 and 1, or 0 to
+		  remove the budget.
+
+		"""
+		return self.__call(lib.qdspSetOverheadBudget, c_double(fraction))
+
+	def setFilterRange(self, attribute, lo, hi):
+		"""Only shows points with an attribute in a range
+		
+		Points outside the range are hidden, and can't be picked or
+		selected. Filters are applied on the GPU, so changing one doesn't
+		upload anything again.
+		
+		:param attribute: :data:`FILTER_X`, :data:`FILTER_Y`, or
+		                  :data:`FILTER_VALUE` for the values from
+		                  :meth:`updateFilter`.
+		:param lo: The smallest value shown.
+		:param hi: The largest value shown. Pass -inf and inf to remove
+		           the filter.
+
+		"""
+		return self.__call(lib.qdspSetFilterRange, attribute, c_double(lo), c_double(hi))
+
+	def setFilterClasses(self, classes):
+		"""Only shows points in some mask classes
+		
+		:param classes: The classes from :meth:`updateFilter` shown, as a
+		                bitmask: bit n shows class n. All are shown by
+		                default.
+
+		"""
+		return self.__call(lib.qdspSetFilterClasses, c_uint(classes))
+
+	def updateFilter(self, values=None, mask=None):
+		"""Uploads per-point data to filter on
+		
+		Both follow the points by index, so they only need uploading when
+		they change.
+		
+		:param values: Values for :data:`FILTER_VALUE`, such as speeds, or
+		               None to filter on none.
+		:param mask: Classes from 0 to 31, such as species, or None to put
+		             every point in class 0.
+		:returns: 0 if the window has been closed, 1 otherwise.
+
+		"""
+		v = None if values is None else _asArray(values, _COORD_TYPES)
+		m = None if mask is None else _asArray(mask, _COLOR_TYPES)
+		sizes = [len(a) for a in (v, m) if a is not None]
+		n = min(sizes) if sizes else 0
+
+		return self.__call(lib.qdspUpdateFilter,
+		                   None if v is None else byref(_describe(v)),
+		                   None if m is None else byref(_describe(m)), n)
+
+	def updateFile(self, path, numPoints, x, y, colors=None):
+		"""Plots points from a file too large to load
+		
+		The file is memory-mapped and streamed to the GPU in chunks through
+		a few fixed-size buffers, so memory use doesn't grow with the file.
+		Streamed points can't be picked or selected, and the bounds aren't
+		fitted to them. The file shouldn't be changed until the next update.
+		
+		Columns are given as (offset, dtype) for packed columns, or (offset,
+		dtype, stride) for fields of records, with offset and stride in
+		bytes. Coordinates can be float64 or float32, and colors int32.
+		
+		:param path: The file to read.
+		:param numPoints: The number of points to render.
+		:param x: Where the x coordinates are in the file.
+		:param y: Where the y coordinates are in the file.
+		:param colors: Where the point colors are in the file, or None.
+		:returns: 1 if the plot was updated successfully, 0 otherwise.
+
+		"""
+		cols = [_column(x), _column(y), None if colors is None else _column(colors)]
+		return self.__call(lib.qdspUpdateFile, path.encode(),
+		                   *[None if c is None else byref(c) for c in cols],
+		                   c_longlong(numPoints))
 
 	def setPointAlpha(self, alpha):
 		"""Sets the point transparency
@@ -144,7 +609,7 @@ class QDSPplot:
 		              opaque), inclusive.
 
 		"""
-		lib.qdspSetPointAlpha(self.ptr, c_double(alpha))
+		return self.__call(lib.qdspSetPointAlpha, c_double(alpha))
 		
 	def setPointColor(self, rgb):
 		"""Sets the default point color
@@ -157,7 +622,7 @@ class QDSPplot:
 
 		"""
 
-		lib.qdspSetPointColor(self.ptr, rgb)
+		return self.__call(lib.qdspSetPointColor, rgb)
 		
 	def setPointSize(self, pixels):
 		"""Sets the size of the plot points
@@ -169,25 +634,56 @@ class QDSPplot:
 		:param pixels: The point width, in pixels.
 
 		"""
-		lib.qdspSetPointSize(self.ptr, pixels)
+		return self.__call(lib.qdspSetPointSize, pixels)
 
-	# helper function for update calls
-	def __xyc2ptr(self, xvals, yvals, colors):
-		# None will not be passed as NULL due to numpy
-		if xvals is None or yvals is None:
-			return -1
+	def setHoverCallback(self, fn):
+		"""Sets a function to call when the point under the cursor changes
 		
-		size = min(len(xvals), len(yvals))
-		xptr = np.asarray(xvals).ctypes.data_as(POINTER(c_double))
-		yptr = np.asarray(yvals).ctypes.data_as(POINTER(c_double))
-		if colors:
-			cptr = np.asarray(colors).ctypes.data_as(POINTER(c_int))
-			# if colors is non-NULL, it can't be too small
-			size = min(size, len(colors))
-		else:
-			cptr = None
+		Points are picked on the GPU and read back without stalling, so fn
+		is called a frame or two after the cursor moves, while the plot is
+		updated or polled (or on the render thread, for a background plot).
 		
-		return [xptr, yptr, cptr, size]
+		:param fn: A function taking the index of the point in the arrays
+		           of the last update, or -1 when there is no point under
+		           the cursor. None removes the callback.
+
+		"""
+		# kept alive for as long as C may call it
+		self.__hover = None if fn is None else _HOVER_CALLBACK(lambda plot, index, data: fn(index))
+		return self.__call(lib.qdspSetHoverCallback, self.__hover, None)
+
+	def setSelectCallback(self, fn):
+		"""Sets a function to call with the points selected with the mouse
+		
+		Dragging with shift and the left button draws a lasso, and with
+		shift and the right button draws a box. The points inside are found
+		on the GPU and highlighted. Pressing 'c' clears the selection.
+		
+		:param fn: A function taking a numpy array of the indices of the
+		           selected points, in the arrays of the last update. The
+		           array is empty when the selection is cleared. None
+		           removes the callback.
+
+		"""
+		def select(plot, indices, count, data):
+			if count == 0:
+				fn(np.empty(0, dtype=np.int32))
+			else:
+				fn(np.ctypeslib.as_array(indices, (count,)).copy())
+
+		self.__select = None if fn is None else _SELECT_CALLBACK(select)
+		return self.__call(lib.qdspSetSelectCallback, self.__select, None)
+
+	# helper function for update calls: float32 or float64 coordinates and
+	# int32 colors are read in place, whatever their strides, and the GIL is
+	# released while the frame is uploaded and drawn
+	def __update(self, xvals, yvals, colors, mode):
+		x = _asArray(xvals, _COORD_TYPES)
+		y = _asArray(yvals, _COORD_TYPES)
+		c = None if colors is None else _asArray(colors, _COLOR_TYPES)
+		if self.background:
+			return self.__frames.submit(x, y, c, mode == 1)
+		return _qdsp.update(self.ptr, x, y, c, mode)
 	
 	def update(self, xvals, yvals, colors=None):
 		"""Updates a plot immediately.
@@ -199,6 +695,13 @@ class QDSPplot:
 		@ref updateIfReady should be preferred in many cases, as repeated calls
 		to update every frame will result in a lot of useless overhead.
 		
+		float32 and float64 coordinates and int32 colors, including strided
+		views and fields of structured arrays, are read without being
+		copied; anything else is converted first. The GIL is released while
+		the plot is updated, so other threads can keep running. For a
+		background plot, this returns a future at once; see
+		:class:`QDSPplot`.
+		
 		:param xvals: An array containing the x coordinates.
 		:param yvals: An array containing the y coordinates.
 		:param colors: An array containing the point colors, represented as
@@ -207,9 +710,46 @@ class QDSPplot:
 		:returns: 1 if the plot was updated successfully, 0 otherwise.
 
 		"""
-		xptr, yptr, cptr, size = self.__xyc2ptr(xvals, yvals, colors)
-		return lib.qdspUpdate(self.ptr, xptr, yptr, cptr, size)
+		return self.__update(xvals, yvals, colors, 0)
 	
+	def updateCurves(self, xvals, yvals, starts, counts, colors=None):
+		"""Updates a plot with many separate curves
+		
+		Curve i connects counts[i] points, starting at index starts[i] of
+		xvals and yvals. All curves are uploaded together and drawn in a
+		single call. Curves must be in order and can't overlap.
+		
+		:param xvals: An array containing the x coordinates.
+		:param yvals: An array containing the y coordinates.
+		:param starts: The index of the first point of each curve.
+		:param counts: The number of points in each curve.
+		:param colors: An array containing one color per curve, represented
+		               as integers, or None for the default color.
+
+		:returns: 1 if the plot was updated successfully, 0 otherwise.
+
+		"""
+		x = np.ascontiguousarray(xvals, dtype=np.float64)
+		y = np.ascontiguousarray(yvals, dtype=np.float64)
+		s = np.ascontiguousarray(starts, dtype=np.int32)
+		c = np.ascontiguousarray(counts, dtype=np.int32)
+		size = min(len(x), len(y))
+		numCurves = min(len(s), len(c))
+		if colors is not None:
+			colors = np.ascontiguousarray(colors, dtype=np.int32)
+			numCurves = min(numCurves, len(colors))
+			cptr = colors.ctypes.data_as(POINTER(c_int))
+		else:
+			cptr = None
+
+		return self.__call(lib.qdspUpdateCurves,
+		                   x.ctypes.data_as(POINTER(c_double)),
+		                   y.ctypes.data_as(POINTER(c_double)),
+		                   size,
+		                   s.ctypes.data_as(POINTER(c_int)),
+		                   c.ctypes.data_as(POINTER(c_int)),
+		                   cptr, numCurves)
+
 	def updateIfReady(self, xvals, yvals, colors=None):
 		"""Updates a plot if enough time has passed since the last update.
 		
@@ -223,6 +763,10 @@ class QDSPplot:
 		eliminates the useless overhead of copying vertex data to the GPU
 		before the monitor can be refreshed.
 		
+		For a background plot, the frame is drawn once the render thread
+		is done with the frames before it, unless a newer one replaces it
+		first; see :class:`QDSPplot`.
+		
 		:param x: An array containing the x coordinates.
 		:param y: An array containing the y coordinates.
 		:param colors: An array containing the point colors, represented as
@@ -232,8 +776,7 @@ class QDSPplot:
 		          an update, 0 otherwise.
 
 		"""
-		xptr, yptr, cptr, size = self.__xyc2ptr(xvals, yvals, colors)
-		return lib.qdspUpdateIfReady(self.ptr, xptr, yptr, cptr, size)
+		return self.__update(xvals, yvals, colors, 1)
 	
 	def updateWait(self, xvals, yvals, colors=None):
 		"""Updates a plot after waiting for a new frame
@@ -245,7 +788,8 @@ class QDSPplot:
 		color is NULL, all points will be the default color.
 		
 		This function is primarily useful when you wish to limit your code
-		to a specific real-time update interval.
+		to a specific real-time update interval. For a background plot, it's
+		the same as @ref update.
 		
 		:param xvals: An array containing the x coordinates.
 		:param yvals: An array containing the y coordinates.
@@ -256,5 +800,4 @@ class QDSPplot:
 		:returns: 1 if the plot was updated successfully, 0 otherwise.
 
 		"""
-		xptr, yptr, cptr, size = self.__xyc2ptr(xvals, yvals, colors)
-		return lib.qdspUpdateWait(self.ptr, xptr, yptr, cptr, size)
+		return self.__update(xvals, yvals, colors, 2)
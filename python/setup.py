@@ -1,6 +1,6 @@
 #!/usr/bin/python3
 
-from setuptools import setup
+from setuptools import setup, Extension
 
 setup(name='qdsp',
       version='1.3.0',
@@ -10,6 +10,9 @@ setup(name='qdsp',
       author_email='matthew.s.mitchell@colorado.edu',
       license='LGPL',
       packages=['qdsp'],
+      # native update calls, linked against the installed C library
+      ext_modules=[Extension('qdsp._qdsp', sources=['qdsp/_qdsp.c'],
+                             libraries=['qdsp'])],
       install_requires=[
           'numpy',
       ],
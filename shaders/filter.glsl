@@ -0,0 +1,26 @@
+// visibility filter, put after the #version line of every shader that draws
+// points: ranges on the position and the filter value, and the mask classes
+// shown; filter data is indexed like the application's arrays, and points past
+// the end of it only have to pass the position ranges
+uniform vec2 xRange;
+uniform vec2 yRange;
+uniform vec2 valueRange;
+uniform uint classes;
+uniform samplerBuffer valueBuf;
+uniform isamplerBuffer maskBuf;
+uniform bool useValues;
+uniform bool useMask;
+uniform int numFiltered;
+
+bool shown(int i, float x, float y) {
+	if (x < xRange.x || x > xRange.y || y < yRange.x || y > yRange.y)
+		return false;
+	if (i >= numFiltered)
+		return true;
+	if (useValues) {
+		float v = texelFetch(valueBuf, i).x;
+		if (v < valueRange.x || v > valueRange.y)
+			return false;
+	}
+	return !useMask || (classes & (1u << (texelFetch(maskBuf, i).x & 31))) != 0u;
+}
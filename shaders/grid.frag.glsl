@@ -4,8 +4,14 @@ out vec4 FragColor;
 
 uniform vec4 xColor;
 uniform vec4 yColor;
+uniform vec4 lineColor;
 uniform int useY;
+uniform int useLine;
 
 void main() {
-	FragColor = (useY != 0) ? yColor : xColor;
+	// overlay lines (HUD graph, zoom box) use their own color
+	if (useLine != 0)
+		FragColor = lineColor;
+	else
+		FragColor = (useY != 0) ? yColor : xColor;
 }
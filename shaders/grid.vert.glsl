@@ -1,6 +1,23 @@
 #version 330 core
 layout (location = 0) in vec2 pos;
 
+// gridlines: first line and spacing, in normalized device coordinates
+uniform vec2 xLines;
+uniform vec2 yLines;
+uniform int useY;
+uniform int useLine;
+
 void main() {
-	gl_Position = vec4(pos, -0.5, 1);
+	// overlay lines (HUD graph, zoom box) come from a vertex buffer
+	if (useLine != 0) {
+		gl_Position = vec4(pos, -0.5, 1);
+		return;
+	}
+
+	// otherwise, one instance per gridline, spanning the window
+	float end = (gl_VertexID == 0) ? -1.0 : 1.0;
+	if (useY != 0)
+		gl_Position = vec4(end, yLines.x + gl_InstanceID * yLines.y, -0.5, 1);
+	else
+		gl_Position = vec4(xLines.x + gl_InstanceID * xLines.y, end, -0.5, 1);
 }
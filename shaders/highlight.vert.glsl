@@ -0,0 +1,71 @@
+#version 330 core
+
+// selected points: one vertex per selected index, fetched from the point
+// buffers and drawn bigger, under the points themselves
+
+uniform float xMin;
+uniform float xMax;
+uniform float yMin;
+uniform float yMax;
+
+uniform int defaultColor;
+uniform int pointSize;
+
+// positions are floats (high precision mode) or doubles, as raw bits
+uniform usamplerBuffer xBuf;
+uniform usamplerBuffer yBuf;
+uniform bool useDouble;
+uniform int numPoints;
+
+// indices are the application's, the buffers hold every stride-th point,
+// starting at the base-th of those
+uniform int stride;
+uniform int base;
+
+layout (location = 0) in int index;
+
+// the filter uniforms and shown() come from filter.glsl
+
+out vec3 myColor;
+
+// same as in lines.vert.glsl: doubles can't be sampled in GLSL 3.30
+float fetchDouble(usamplerBuffer buf, int i) {
+	uvec2 v = texelFetch(buf, i).xy;
+	uint sign = v.y & 0x80000000u;
+	int e = int((v.y >> 20) & 0x7ffu) - 1023 + 127;
+	uint mant = ((v.y & 0xfffffu) << 3) | (v.x >> 29);
+
+	if (e >= 1151)
+		return uintBitsToFloat(sign | 0x7f800000u | (mant != 0u ? 0x400000u : 0u));
+	if (e >= 255)
+		return uintBitsToFloat(sign | 0x7f800000u);
+	if (e <= 0)
+		return uintBitsToFloat(sign);
+	return uintBitsToFloat(sign | (uint(e) << 23) | mant);
+}
+
+float fetch(usamplerBuffer buf, int i) {
+	return useDouble ? fetchDouble(buf, i) : uintBitsToFloat(texelFetch(buf, i).x);
+}
+
+void main() {
+	gl_PointSize = pointSize;
+
+	// not on the GPU right now, or filtered out since: clipped
+	int i = index / stride - base;
+	bool held = i >= 0 && i < numPoints;
+	float xPos = held ? fetch(xBuf, i) : 0.0;
+	float yPos = held ? fetch(yBuf, i) : 0.0;
+	if (index % stride != 0 || !held || !shown(index, xPos, yPos)) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+
+	float x = 2 * (xPos - xMin) / (xMax - xMin) - 1;
+	float y = 2 * (yPos - yMin) / (yMax - yMin) - 1;
+	gl_Position = vec4(x, y, 0.0, 1.0);
+
+	myColor = vec3((0xff & (defaultColor >> 16)) / 255.0,
+	               (0xff & (defaultColor >> 8)) / 255.0,
+	               (0xff & defaultColor) / 255.0);
+}
@@ -0,0 +1,27 @@
+#version 330 core
+
+in vec3 myColor;
+in vec2 segCoord;
+flat in float segLength;
+
+out vec4 FragColor;
+
+uniform float alpha;
+uniform float halfWidth;
+uniform bool roundJoin;
+
+void main() {
+	// distance from the segment, in pixels
+	float dist = abs(segCoord.y);
+	if (roundJoin) {
+		float t = clamp(segCoord.x, 0.0, segLength);
+		dist = length(vec2(segCoord.x - t, segCoord.y));
+	}
+
+	// coverage of this pixel, for antialiasing
+	float coverage = clamp(halfWidth + 0.5 - dist, 0.0, 1.0);
+	if (coverage <= 0.0)
+		discard;
+
+	FragColor = vec4(myColor, alpha * coverage);
+}
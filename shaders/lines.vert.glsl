@@ -0,0 +1,172 @@
+#version 330 core
+
+// thick lines: one instance per segment, drawn as a 4-vertex triangle strip.
+// Points are fetched from the same buffers the points program uses, through
+// texture buffers, so nothing is expanded on the CPU.
+
+uniform float xMin;
+uniform float xMax;
+uniform float yMin;
+uniform float yMax;
+
+uniform bool useCustom;
+uniform int defaultColor;
+
+// positions are floats (high precision mode) or doubles, as raw bits
+uniform usamplerBuffer xBuf;
+uniform usamplerBuffer yBuf;
+uniform isamplerBuffer colorBuf;
+uniform bool useDouble;
+uniform int numPoints;
+
+// separate curves: start, count and color of each, in order; otherwise one
+// curve runs through every point
+uniform isamplerBuffer curveBuf;
+uniform bool useCurves;
+uniform bool useCurveColor;
+uniform int numCurves;
+
+// the filter uniforms and shown() come from filter.glsl
+
+uniform vec2 pixDims;
+uniform float halfWidth;
+uniform bool roundJoin;
+
+out vec3 myColor;
+// position relative to the start of the segment, along and across it, in px
+out vec2 segCoord;
+flat out float segLength;
+
+// sharper corners than this (cosine of half the turning angle) get butt ends
+// instead of miters
+const float MITER_LIMIT = 0.25;
+
+// doubles can't be sampled in GLSL 3.30, so convert the bits by hand
+// (truncating, and flushing anything too small for a float to 0)
+float fetchDouble(usamplerBuffer buf, int i) {
+	uvec2 v = texelFetch(buf, i).xy;
+	uint sign = v.y & 0x80000000u;
+	int e = int((v.y >> 20) & 0x7ffu) - 1023 + 127;
+	uint mant = ((v.y & 0xfffffu) << 3) | (v.x >> 29);
+
+	if (e >= 1151) // 0x7ff, inf or NaN
+		return uintBitsToFloat(sign | 0x7f800000u | (mant != 0u ? 0x400000u : 0u));
+	if (e >= 255)
+		return uintBitsToFloat(sign | 0x7f800000u);
+	if (e <= 0)
+		return uintBitsToFloat(sign);
+	return uintBitsToFloat(sign | (uint(e) << 23) | mant);
+}
+
+float fetch(usamplerBuffer buf, int i) {
+	return useDouble ? fetchDouble(buf, i) : uintBitsToFloat(texelFetch(buf, i).x);
+}
+
+// point i, in pixels
+vec2 point(int i) {
+	vec2 p = vec2(fetch(xBuf, i), fetch(yBuf, i));
+	return (p - vec2(xMin, yMin)) / vec2(xMax - xMin, yMax - yMin) * pixDims;
+}
+
+// lines are never thinned, so points are the application's
+bool shownPoint(int i) {
+	return shown(i, fetch(xBuf, i), fetch(yBuf, i));
+}
+
+bool valid(vec2 p) {
+	return !isnan(p.x) && !isnan(p.y) && !isinf(p.x) && !isinf(p.y);
+}
+
+vec3 unpack(int rgb) {
+	return vec3((0xff & (rgb >> 16)) / 255.0,
+	            (0xff & (rgb >> 8)) / 255.0,
+	            (0xff & rgb) / 255.0);
+}
+
+// puts every vertex of the segment in the same place, so nothing is drawn
+void collapse() {
+	gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+	myColor = vec3(0.0);
+	segCoord = vec2(0.0);
+	segLength = 0.0;
+}
+
+void main() {
+	int i = gl_InstanceID;
+	int end = gl_VertexID >> 1;
+	float side = (gl_VertexID & 1) != 0 ? 1.0 : -1.0;
+
+	// points this segment's curve runs between
+	int first = 0;
+	int last = numPoints - 1;
+	int rgb = defaultColor;
+	if (useCurves) {
+		// last curve starting at or before this segment
+		int lo = 0;
+		int hi = numCurves - 1;
+		while (lo < hi) {
+			int mid = (lo + hi + 1) / 2;
+			if (texelFetch(curveBuf, mid).x <= i)
+				lo = mid;
+			else
+				hi = mid - 1;
+		}
+
+		ivec4 curve = texelFetch(curveBuf, lo);
+		first = curve.x;
+		last = curve.x + curve.y - 1;
+		if (useCurveColor)
+			rgb = curve.z;
+	}
+
+	// segments between curves are skipped
+	if (i < first || i >= last) {
+		collapse();
+		return;
+	}
+
+	vec2 a = point(i);
+	vec2 b = point(i + 1);
+
+	// broken segments (NaN or hidden endpoints) collapse to nothing
+	if (!valid(a) || !valid(b) || !shownPoint(i) || !shownPoint(i + 1)) {
+		collapse();
+		return;
+	}
+
+	segLength = length(b - a);
+	vec2 dir = segLength > 1.0e-6 ? (b - a) / segLength : vec2(1.0, 0.0);
+	vec2 normal = vec2(-dir.y, dir.x);
+
+	// one extra pixel for the antialiasing ramp
+	float ext = halfWidth + 1.0;
+	vec2 base = (end == 0) ? a : b;
+	vec2 offset = normal * side * ext;
+
+	if (roundJoin) {
+		// capsules; overlapping ends make the round joins
+		offset += dir * ((end == 0) ? -ext : ext);
+	} else {
+		// miter against the neighboring segment, if there is one
+		int j = (end == 0) ? i - 1 : i + 2;
+		if (j >= first && j <= last) {
+			vec2 c = point(j);
+			vec2 other = (end == 0) ? a - c : c - b;
+			if (valid(c) && shownPoint(j) && length(other) > 1.0e-6) {
+				vec2 tangent = normalize(dir + normalize(other));
+				vec2 miter = vec2(-tangent.y, tangent.x);
+				float cosHalf = dot(miter, normal);
+				if (cosHalf > MITER_LIMIT)
+					offset = miter * side * ext / cosHalf;
+			}
+		}
+	}
+
+	vec2 pos = base + offset;
+	segCoord = vec2(dot(pos - a, dir), dot(pos - a, normal));
+	gl_Position = vec4(2.0 * pos / pixDims - 1.0, 0.0, 1.0);
+
+	if (useCustom)
+		rgb = texelFetch(colorBuf, i + end).x;
+	myColor = unpack(rgb);
+}
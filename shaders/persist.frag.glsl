@@ -0,0 +1,12 @@
+#version 330 core
+
+in vec2 texCoord;
+
+out vec4 FragColor;
+
+uniform sampler2D myTex;
+
+void main() {
+	// colors are premultiplied by alpha
+	FragColor = texture(myTex, texCoord);
+}
@@ -0,0 +1,8 @@
+#version 330 core
+
+flat in uint pickId;
+out uint FragId;
+
+void main() {
+	FragId = pickId;
+}
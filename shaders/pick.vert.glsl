@@ -0,0 +1,36 @@
+#version 330 core
+
+// hover picking: points are drawn with their index + 1 into an integer target
+// around the cursor, where 0 means no point
+
+uniform float xMin;
+uniform float xMax;
+uniform float yMin;
+uniform float yMax;
+
+uniform int pointSize;
+uniform int stride;
+uniform int base;
+
+// the filter uniforms and shown() come from filter.glsl
+
+layout (location = 0) in float xPos;
+layout (location = 1) in float yPos;
+
+flat out uint pickId;
+
+void main() {
+	// hidden points can't be picked
+	if (!shown((base + gl_VertexID) * stride, xPos, yPos)) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+
+	float x = 2 * (xPos - xMin) / (xMax - xMin) - 1;
+	float y = 2 * (yPos - yMin) / (yMax - yMin) - 1;
+	gl_Position = vec4(x, y, 0.0, 1.0);
+
+	gl_PointSize = pointSize;
+
+	pickId = uint(base + gl_VertexID + 1);
+}
@@ -9,6 +9,14 @@ uniform bool useCustom;
 uniform int defaultColor;
 uniform int pointSize;
 
+// points on the GPU are every stride-th one the application passed, and the
+// buffers being drawn start at the base-th of those (-1 if the application's
+// indices don't fit in an int, which skips the filter data)
+uniform int stride;
+uniform int base;
+
+// the filter uniforms and shown() come from filter.glsl
+
 layout (location = 0) in float xPos;
 layout (location = 1) in float yPos;
 layout (location = 2) in int customColor;
@@ -16,6 +24,13 @@ layout (location = 2) in int customColor;
 out vec3 myColor;
 
 void main() {
+	// hidden points are moved out of the clip volume
+	int i = base < 0 ? numFiltered : (base + gl_VertexID) * stride;
+	if (!shown(i, xPos, yPos)) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		return;
+	}
+
 	float x = 2 * (xPos - xMin) / (xMax - xMin) - 1;
 	float y = 2 * (yPos - yMin) / (yMax - yMin) - 1;
 	gl_Position = vec4(x, y, 0.0, 1.0);
@@ -0,0 +1,19 @@
+#version 330 core
+
+// only points inside the selection make it to the feedback buffer
+
+layout (points) in;
+layout (points, max_vertices = 1) out;
+
+flat in int index[];
+flat in int inside[];
+
+flat out int selected;
+
+void main() {
+	if (inside[0] != 0) {
+		selected = index[0];
+		EmitVertex();
+		EndPrimitive();
+	}
+}
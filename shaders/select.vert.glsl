@@ -0,0 +1,52 @@
+#version 330 core
+
+// selection: every point is tested against the box or lasso here, and the
+// geometry shader passes the indices of the ones inside on to transform
+// feedback
+
+uniform float xMin;
+uniform float xMax;
+uniform float yMin;
+uniform float yMax;
+
+// polygon in normalized device coordinates, and its bounding box
+uniform samplerBuffer lasso;
+uniform int numLasso;
+uniform vec4 lassoBounds;
+
+// points on the GPU are every stride-th one the application passed, and the
+// buffers being drawn start at the base-th of those
+uniform int stride;
+uniform int base;
+
+// the filter uniforms and shown() come from filter.glsl
+
+layout (location = 0) in float xPos;
+layout (location = 1) in float yPos;
+
+flat out int index;
+flat out int inside;
+
+void main() {
+	vec2 p = vec2(2 * (xPos - xMin) / (xMax - xMin) - 1,
+	              2 * (yPos - yMin) / (yMax - yMin) - 1);
+	index = (base + gl_VertexID) * stride;
+	inside = 0;
+
+	// nor selected
+	if (!shown(index, xPos, yPos))
+		return;
+
+	if (p.x < lassoBounds.x || p.x > lassoBounds.z ||
+	    p.y < lassoBounds.y || p.y > lassoBounds.w)
+		return;
+
+	// even-odd rule: count the edges a ray to the right of the point crosses
+	for (int i = 0, j = numLasso - 1; i < numLasso; j = i++) {
+		vec2 a = texelFetch(lasso, i).xy;
+		vec2 b = texelFetch(lasso, j).xy;
+		if ((a.y > p.y) != (b.y > p.y) &&
+		    p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x)
+			inside ^= 1;
+	}
+}
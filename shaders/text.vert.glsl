@@ -1,18 +1,23 @@
 #version 330 core
 
+// one instance per character
 layout (location = 0) in vec2 start;
 layout (location = 1) in vec2 offset;
-layout (location = 2) in vec2 st;
+layout (location = 2) in uint glyph;
 
 out vec2 texCoord;
 
 uniform vec2 pixDims;
 uniform vec2 charDims;
+uniform float atlasChars;
 
 void main() {
-	texCoord = st;
+	// corners of the character cell, drawn as a triangle strip
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+	texCoord = vec2((float(glyph) + corner.x) / atlasChars, 1.0 - corner.y);
+
 	vec2 sizeFrac = charDims / pixDims;
 	// shift up & right by 1px to avoid interfering with grid lines
 	vec2 pixShift = vec2(1.0, 1.0)/pixDims;
-	gl_Position = vec4(start + sizeFrac * offset + pixShift, 0.75, 1.0);
+	gl_Position = vec4(start + sizeFrac * (offset + corner) + pixShift, 0.75, 1.0);
 }
@@ -0,0 +1,11 @@
+#version 330 core
+
+in vec3 myColor;
+in float fade;
+out vec4 FragColor;
+
+uniform float alpha;
+
+void main() {
+	FragColor = vec4(myColor, alpha * fade);
+}
@@ -0,0 +1,76 @@
+#version 330 core
+
+// trails: one instance per particle, drawn as GL_LINES between its positions
+// in consecutive frames of the ring, newest first
+
+uniform float xMin;
+uniform float xMax;
+uniform float yMin;
+uniform float yMax;
+
+uniform bool useCustom;
+uniform int defaultColor;
+
+// ring of past positions, frame-major, as raw float or double bits
+uniform usamplerBuffer xRing;
+uniform usamplerBuffer yRing;
+uniform isamplerBuffer colorBuf;
+uniform bool useDouble;
+
+uniform int trailLength; // frames in the ring
+uniform int head; // slot of the newest frame
+uniform int count; // particles per frame
+uniform int stride; // particles are every stride-th point passed in
+
+// the filter uniforms and shown() come from filter.glsl
+
+out vec3 myColor;
+out float fade;
+
+// same as in lines.vert.glsl: doubles can't be sampled in GLSL 3.30
+float fetchDouble(usamplerBuffer buf, int i) {
+	uvec2 v = texelFetch(buf, i).xy;
+	uint sign = v.y & 0x80000000u;
+	int e = int((v.y >> 20) & 0x7ffu) - 1023 + 127;
+	uint mant = ((v.y & 0xfffffu) << 3) | (v.x >> 29);
+
+	if (e >= 1151)
+		return uintBitsToFloat(sign | 0x7f800000u | (mant != 0u ? 0x400000u : 0u));
+	if (e >= 255)
+		return uintBitsToFloat(sign | 0x7f800000u);
+	if (e <= 0)
+		return uintBitsToFloat(sign);
+	return uintBitsToFloat(sign | (uint(e) << 23) | mant);
+}
+
+float fetch(usamplerBuffer buf, int i) {
+	return useDouble ? fetchDouble(buf, i) : uintBitsToFloat(texelFetch(buf, i).x);
+}
+
+void main() {
+	// vertex 2s and 2s+1 are segment s, from age s to age s+1
+	int age = (gl_VertexID >> 1) + (gl_VertexID & 1);
+	int slot = (head - age + trailLength) % trailLength;
+	int idx = slot * count + gl_InstanceID;
+
+	// hidden particles lose their whole trail, by where they are now
+	int now = head * count + gl_InstanceID;
+	if (!shown(gl_InstanceID * stride, fetch(xRing, now), fetch(yRing, now))) {
+		gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+		myColor = vec3(0.0);
+		fade = 0.0;
+		return;
+	}
+
+	float x = 2 * (fetch(xRing, idx) - xMin) / (xMax - xMin) - 1;
+	float y = 2 * (fetch(yRing, idx) - yMin) / (yMax - yMin) - 1;
+	gl_Position = vec4(x, y, 0.0, 1.0);
+
+	// fades out linearly with age
+	fade = 1.0 - float(age) / float(trailLength);
+
+	int rgb = useCustom ? texelFetch(colorBuf, gl_InstanceID).x : defaultColor;
+	myColor = vec3((0xff & (rgb >> 16)) / 255.0,
+	               (0xff & (rgb >> 8)) / 255.0,
+	               (0xff & rgb) / 255.0);
+}
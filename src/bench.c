@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "glad/glad.h"
+#include "qdsp.h"
+
+// Benchmark harness for QDSP, built and run by 'make bench'.
+//
+// Each configuration gets a fresh plot, so qdspInit latency is measured every
+// time. Point counts are swept from 10^3 up to 10^max, 10^8 by default. That
+// needs 2 GB for the input arrays, and takes a while on a software renderer
+// like llvmpipe, so -max 7 is quicker there. At every count, a baseline
+// configuration is run, followed by one run per option with only that option
+// changed (or every combination, with -full). Results are written as CSV or
+// JSON so they can be compared across commits. The spatial sort pays
+// off where it saves more in gpuPointsMs, the GPU time spent drawing points,
+// than it adds to the update time; -full shows it with big or blended points.
+//
+// Usage: qdspbench [-min exp] [-max exp] [-frames n] [-seconds s] [-full]
+//                  [-json] [-o file]
+
+#ifndef QDSP_BENCH_COMMIT
+#define QDSP_BENCH_COMMIT "unknown"
+#endif
+
+// upload strategies; each one takes the same double-precision input
+typedef struct Strategy {
+	const char *name;
+	void (*setup)(QDSPplot *plot);
+} Strategy;
+
+// doubles straight from the caller's arrays
+static void setupDouble(QDSPplot *plot) {
+	(void)plot;
+}
+
+// float offsets, converted by the kernels during the upload pass
+static void setupFloat(QDSPplot *plot) {
+	qdspSetHighPrecision(plot, 1);
+}
+
+// doubles through the mapped upload pass, with the range found on the way
+static void setupAuto(QDSPplot *plot) {
+	qdspSetAutoBounds(plot, QDSP_AUTO_TIGHT);
+}
+
+static const Strategy STRATEGIES[] = {
+	{"double", setupDouble},
+	{"float", setupFloat},
+	{"auto", setupAuto},
+};
+static const int NUM_STRATEGIES = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+
+typedef struct Config {
+	int strategy;
+	long numPoints;
+	int color;
+	int pointSize;
+	double alpha;
+	int connected;
+	int grid;
+	int sort;
+} Config;
+
+typedef struct Result {
+	double initMs;
+	int frames;
+	double msMean, msP50, msP90, msP99;
+	double pointsPerSec;
+	double bytesPerSec;
+	double gpuPointsMs;
+} Result;
+
+static double *xBuf, *yBuf;
+static int *colorBuf;
+
+static char renderer[256] = "unknown";
+
+static double msDiff(const struct timespec *start, const struct timespec *end) {
+	return ((double)end->tv_sec*1.0e3 + end->tv_nsec*1.0e-6) -
+		((double)start->tv_sec*1.0e3 + start->tv_nsec*1.0e-6);
+}
+
+static int compareDoubles(const void *a, const void *b) {
+	double da = *(const double*)a, db = *(const double*)b;
+	return (da > db) - (da < db);
+}
+
+static double percentile(const double *sorted, int n, double p) {
+	int idx = (int)ceil(p * n) - 1;
+	if (idx < 0) idx = 0;
+	if (idx >= n) idx = n - 1;
+	return sorted[idx];
+}
+
+static int runConfig(const Config *cfg, int maxFrames, double maxSeconds, Result *res) {
+	struct timespec start, end;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	QDSPplot *plot = qdspInit("QDSP benchmark");
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	if (plot == NULL)
+		return 0;
+	res->initMs = msDiff(&start, &end);
+
+	if (strcmp(renderer, "unknown") == 0)
+		snprintf(renderer, sizeof(renderer), "%s", glGetString(GL_RENDERER));
+
+	qdspSetFramerate(plot, 0);
+	qdspSetPointSize(plot, cfg->pointSize);
+	qdspSetPointAlpha(plot, cfg->alpha);
+	qdspSetConnected(plot, cfg->connected);
+	qdspSetSpatialSort(plot, cfg->sort);
+	qdspSetGridX(plot, -1, 0.25, 0x444444);
+	qdspSetGridY(plot, -1, 0.25, 0x444444);
+	qdspSetGridVisible(plot, cfg->grid);
+	STRATEGIES[cfg->strategy].setup(plot);
+
+	int *color = cfg->color ? colorBuf : NULL;
+	int n = (int)cfg->numPoints;
+
+	// warm up, so buffer allocation and shader compilation aren't counted
+	for (int i = 0; i < 3; i++)
+		qdspUpdate(plot, xBuf, yBuf, color, n);
+
+	double *times = malloc(maxFrames * sizeof(double));
+	struct timespec benchStart;
+	clock_gettime(CLOCK_MONOTONIC, &benchStart);
+
+	int frames = 0;
+	double totalMs = 0;
+	while (frames < maxFrames && (frames < 5 || totalMs < 1000 * maxSeconds)) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		if (!qdspUpdate(plot, xBuf, yBuf, color, n))
+			break;
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		times[frames++] = msDiff(&start, &end);
+		totalMs = msDiff(&benchStart, &end);
+	}
+
+	QDSPstats stats;
+	qdspGetStats(plot, &stats);
+	qdspDelete(plot);
+
+	if (frames == 0) {
+		free(times);
+		return 0;
+	}
+
+	qsort(times, frames, sizeof(double), compareDoubles);
+	res->frames = frames;
+	res->msMean = totalMs / frames;
+	res->msP50 = percentile(times, frames, 0.50);
+	res->msP90 = percentile(times, frames, 0.90);
+	res->msP99 = percentile(times, frames, 0.99);
+	res->pointsPerSec = 1000.0 * frames * cfg->numPoints / totalMs;
+	res->bytesPerSec = (double)stats.bytesUploaded / stats.pointsUploaded
+		* res->pointsPerSec;
+	res->gpuPointsMs = stats.gpuPointsMs;
+
+	free(times);
+	return 1;
+}
+
+static void printHeader(FILE *out, int json) {
+	if (json)
+		fprintf(out, "{\n  \"commit\": \"%s\",\n  \"results\": [\n", QDSP_BENCH_COMMIT);
+	else
+		fprintf(out, "commit,renderer,strategy,points,color,pointSize,alpha,"
+		        "connected,grid,sort,initMs,frames,msMean,msP50,msP90,msP99,"
+		        "pointsPerSec,MBPerSec,gpuPointsMs\n");
+}
+
+static void printResult(FILE *out, int json, int first, const Config *cfg, const Result *res) {
+	if (json) {
+		fprintf(out, "%s    {\"renderer\": \"%s\", \"strategy\": \"%s\", \"points\": %ld, "
+		        "\"color\": %d, \"pointSize\": %d, \"alpha\": %g, "
+		        "\"connected\": %d, \"grid\": %d, \"sort\": %d, \"initMs\": %.3f, "
+		        "\"frames\": %d, \"msMean\": %.3f, \"msP50\": %.3f, "
+		        "\"msP90\": %.3f, \"msP99\": %.3f, \"pointsPerSec\": %.6e, "
+		        "\"MBPerSec\": %.3f, \"gpuPointsMs\": %.3f}",
+		        first ? "" : ",\n", renderer, STRATEGIES[cfg->strategy].name,
+		        cfg->numPoints, cfg->color, cfg->pointSize, cfg->alpha,
+		        cfg->connected, cfg->grid, cfg->sort, res->initMs, res->frames,
+		        res->msMean, res->msP50, res->msP90, res->msP99, res->pointsPerSec,
+		        res->bytesPerSec * 1.0e-6, res->gpuPointsMs);
+	} else {
+		fprintf(out, "%s,\"%s\",%s,%ld,%d,%d,%g,%d,%d,%d,%.3f,%d,%.3f,%.3f,%.3f,"
+		        "%.3f,%.6e,%.3f,%.3f\n",
+		        QDSP_BENCH_COMMIT, renderer, STRATEGIES[cfg->strategy].name,
+		        cfg->numPoints, cfg->color, cfg->pointSize, cfg->alpha,
+		        cfg->connected, cfg->grid, cfg->sort, res->initMs, res->frames,
+		        res->msMean, res->msP50, res->msP90, res->msP99, res->pointsPerSec,
+		        res->bytesPerSec * 1.0e-6, res->gpuPointsMs);
+	}
+	fflush(out);
+}
+
+static void printFooter(FILE *out, int json) {
+	if (json)
+		fprintf(out, "\n  ]\n}\n");
+}
+
+int main(int argc, char **argv) {
+	int minExp = 3, maxExp = 8;
+	int maxFrames = 200;
+	double maxSeconds = 2.0;
+	int full = 0;
+	int json = 0;
+	const char *outPath = NULL;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-min") && i + 1 < argc) minExp = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-max") && i + 1 < argc) maxExp = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-frames") && i + 1 < argc) maxFrames = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-seconds") && i + 1 < argc) maxSeconds = atof(argv[++i]);
+		else if (!strcmp(argv[i], "-full")) full = 1;
+		else if (!strcmp(argv[i], "-json")) json = 1;
+		else if (!strcmp(argv[i], "-o") && i + 1 < argc) outPath = argv[++i];
+		else {
+			fprintf(stderr, "Usage: %s [-min exp] [-max exp] [-frames n] "
+			        "[-seconds s] [-full] [-json] [-o file]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (maxExp > 8) maxExp = 8;
+	if (minExp < 0) minExp = 0;
+	if (maxFrames < 1) maxFrames = 1;
+
+	FILE *out = outPath ? fopen(outPath, "w") : stdout;
+	if (out == NULL) {
+		fprintf(stderr, "Could not open %s\n", outPath);
+		return 1;
+	}
+
+	// fixed seed, so every commit draws the same points
+	long maxPoints = lround(pow(10, maxExp));
+	xBuf = malloc(maxPoints * sizeof(double));
+	yBuf = malloc(maxPoints * sizeof(double));
+	colorBuf = malloc(maxPoints * sizeof(int));
+	if (xBuf == NULL || yBuf == NULL || colorBuf == NULL) {
+		fprintf(stderr, "Could not allocate %ld points\n", maxPoints);
+		return 1;
+	}
+
+	srand(1);
+	for (long i = 0; i < maxPoints; i++) {
+		xBuf[i] = 2.0 * rand() / RAND_MAX - 1;
+		yBuf[i] = 2.0 * rand() / RAND_MAX - 1;
+		colorBuf[i] = rand() & 0xffffff;
+	}
+
+	printHeader(out, json);
+
+	int first = 1;
+	for (int e = minExp; e <= maxExp; e++) {
+		for (int s = 0; s < NUM_STRATEGIES; s++) {
+			// bit 0: color, 1: point size, 2: alpha, 3: connected, 4: grid,
+			// 5: spatial sort
+			for (int opts = 0; opts < 64; opts++) {
+				// one option at a time unless we're doing the full sweep
+				if (!full && (opts & (opts - 1)))
+					continue;
+
+				Config cfg = {
+					.strategy = s,
+					.numPoints = lround(pow(10, e)),
+					.color = !!(opts & 1),
+					.pointSize = (opts & 2) ? 4 : 1,
+					.alpha = (opts & 4) ? 0.5 : 1.0,
+					.connected = !!(opts & 8),
+					.grid = !!(opts & 16),
+					.sort = !!(opts & 32)
+				};
+
+				Result res;
+				if (!runConfig(&cfg, maxFrames, maxSeconds, &res)) {
+					fprintf(stderr, "Benchmark failed for %ld points\n", cfg.numPoints);
+					continue;
+				}
+				printResult(out, json, first, &cfg, &res);
+				first = 0;
+			}
+		}
+	}
+
+	printFooter(out, json);
+
+	if (out != stdout)
+		fclose(out);
+
+	free(xBuf);
+	free(yBuf);
+	free(colorBuf);
+
+	return 0;
+}
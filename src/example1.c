@@ -15,7 +15,7 @@ const int PART_NUM = 100000;
 
 void init(double *x, double *y, int *color);
 
-int main(int argc, char **argv) {
+int main(void) {
 	// allocate memory
 	double *xcoord = malloc(PART_NUM * sizeof(double));
 	double *ycoord = malloc(PART_NUM * sizeof(double));
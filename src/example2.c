@@ -34,7 +34,7 @@ void poisson(double *rho, double *e);
 void xPush(double *x, double *v);
 void vHalfPush(double *x, double *v, double *e, int forward);
 
-int main(int argc, char **argv) {
+int main(void) {
 	DX = XMAX / NGRID;
 	// allocate memory
 	double *x = malloc(PART_NUM * sizeof(double));
@@ -0,0 +1,95 @@
+! Fortran example: particles in a derived type, plotted in place
+!
+! The phase space of a set of particles bouncing in a box is drawn straight
+! from the particle array. parts%x and parts%v are strided sections of it, and
+! QDSP reads them through their strides, so nothing is copied into scratch
+! arrays every frame.
+
+program example3
+  use iso_c_binding, only: c_ptr,c_int,c_double,c_associated
+  use qdsp_interface
+  implicit none
+
+  ! system dimensions
+  real(kind=c_double),parameter :: XMAX=16.0d0,VMAX=1.0d0
+
+  ! particle number
+  integer,parameter :: PART_NUM=100000
+
+  type :: particle
+    real(kind=c_double) :: x,v
+    integer(kind=c_int) :: species
+  end type
+
+  type(particle),allocatable :: parts(:)
+  integer(kind=c_int),allocatable :: color(:)
+  type(c_ptr) :: plot
+  real(kind=c_double) :: r
+  integer(kind=c_int) :: open
+  integer :: n,frames
+
+  allocate(parts(PART_NUM),color(PART_NUM))
+
+  ! two species with different speeds, colored by species
+  do n=1,PART_NUM
+    call random_number(r)
+    parts(n)%x=XMAX*r
+    call random_number(r)
+    parts(n)%species=mod(n,2)
+    parts(n)%v=VMAX*(2*r-1)*(1+parts(n)%species)/2
+    color(n)=merge(int(z'ff4400',c_int),int(z'0088ff',c_int),parts(n)%species==1)
+  end do
+
+  !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+  ! This is the first section relevant to QDSP
+
+  ! create phase plot with given title; a null pointer means the window
+  ! couldn't be created
+  plot=qdspInit('QDSP Fortran Example')
+  if (.not. c_associated(plot)) stop 'could not create plot'
+
+  ! xmin, xmax, ymin, ymax
+  call qdspSetBounds(plot,0.0d0,XMAX,-VMAX,VMAX)
+
+  ! gridlines every 2 in x and 0.5 in v, toggled by pressing 'g'
+  call qdspSetGridX(plot,0.0d0,2.0d0,int(z'444444',c_int))
+  call qdspSetGridY(plot,0.0d0,0.5d0,int(z'444444',c_int))
+
+  call qdspSetPointSize(plot,2)
+  call qdspSetText(plot,0,0.02d0,0.95d0,'x-v phase space')
+
+  ! see below for update and cleanup code
+  !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+  open=1
+  frames=0
+  do while (open/=0)
+    ! move particles, reflecting off the walls
+    do n=1,PART_NUM
+      parts(n)%x=parts(n)%x+0.01d0*parts(n)%v
+      if (parts(n)%x<0 .or. parts(n)%x>XMAX) then
+        parts(n)%v=-parts(n)%v
+        parts(n)%x=min(max(parts(n)%x,0.0d0),XMAX)
+      end if
+    end do
+
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+    ! Waits for the next frame, then copies the coordinates to the GPU and
+    ! redraws. Any real(4) or real(8) arrays can be passed, including
+    ! sections and derived-type components, and the color array is
+    ! optional. The number of points is the length of the shortest array.
+    !
+    ! The function returns 0 once the window has been closed.
+    open=qdspUpdateWait(plot,parts%x,parts%v,color)
+    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+
+    if (open==1) frames=frames+1
+  end do
+
+  print '(i0,a)',frames,' frames'
+
+  ! frees plot resources
+  call qdspDelete(plot)
+  deallocate(parts,color)
+
+end program
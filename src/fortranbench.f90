@@ -0,0 +1,113 @@
+! Benchmark for the Fortran bindings, built and run by 'make bench-fortran'.
+!
+! Particles are kept in a derived type, as in a PIC code, and uploaded with
+! framerate capping off. Each point count is run with the old interface, which
+! copies the coordinates into scratch arrays for c_loc every frame, and with
+! the array interface reading the strided components in place, as real(8) and
+! real(4). Contiguous real(8) arrays are the baseline. Results are written as
+! CSV.
+!
+! Usage: fortranbench [min exp] [max exp] [frames]
+
+program fortranbench
+  use iso_c_binding, only: c_ptr,c_int,c_float,c_double,c_null_ptr,c_loc,c_associated
+  use qdsp_interface
+  implicit none
+
+  type :: particle
+    real(kind=c_double) :: x,y,vx,vy
+  end type
+
+  type :: particle32
+    real(kind=c_float) :: x,y,vx,vy
+  end type
+
+  character(len=*),parameter :: METHODS(4)=[character(len=10) :: 'contiguous','copy', &
+                                            'strided','strided32']
+
+  type(particle),allocatable :: parts(:)
+  type(particle32),allocatable :: parts32(:)
+  real(kind=c_double),allocatable,target :: xBuf(:),yBuf(:)
+  character(len=16) :: arg
+  integer :: minExp,maxExp,maxFrames,e,m,n,f,seedSize
+  integer(kind=8) :: start,finish,rate
+  real(kind=c_double) :: ms
+  type(c_ptr) :: plot
+  integer(kind=c_int) :: ret
+
+  minExp=3
+  maxExp=7
+  maxFrames=100
+  if (command_argument_count()>=1) then
+    call get_command_argument(1,arg)
+    read(arg,*) minExp
+  end if
+  if (command_argument_count()>=2) then
+    call get_command_argument(2,arg)
+    read(arg,*) maxExp
+  end if
+  if (command_argument_count()>=3) then
+    call get_command_argument(3,arg)
+    read(arg,*) maxFrames
+  end if
+
+  ! fixed seed, so every run draws the same points
+  n=10**maxExp
+  allocate(parts(n),parts32(n),xBuf(n),yBuf(n))
+  call random_seed(size=seedSize)
+  call random_seed(put=[(1,f=1,seedSize)])
+  call random_number(parts%x)
+  call random_number(parts%y)
+  parts%x=2*parts%x-1
+  parts%y=2*parts%y-1
+  parts32%x=real(parts%x,c_float)
+  parts32%y=real(parts%y,c_float)
+  xBuf=parts%x
+  yBuf=parts%y
+
+  print '(a)','method,points,frames,msMean,pointsPerSec'
+
+  do e=minExp,maxExp
+    n=10**e
+    do m=1,size(METHODS)
+      plot=qdspInit('QDSP Fortran benchmark')
+      if (.not. c_associated(plot)) stop 'could not create plot'
+      call qdspSetFramerate(plot,0.0d0)
+
+      ! warm up, so buffer allocation and shader compilation aren't counted
+      do f=1,3
+        ret=frame(m,n)
+      end do
+
+      call system_clock(start,rate)
+      do f=1,maxFrames
+        if (frame(m,n)==0) exit
+      end do
+      call system_clock(finish)
+      call qdspDelete(plot)
+
+      ms=1000.0d0*(finish-start)/rate
+      print '(a,",",i0,",",i0,",",f0.3,",",es12.6)',trim(METHODS(m)),n,f-1, &
+        ms/(f-1),1000.0d0*(f-1)*n/ms
+    end do
+  end do
+
+contains
+
+  integer(kind=c_int) function frame(method,n)
+    integer,intent(in) :: method,n
+    select case (method)
+    case (1)
+      frame=qdspUpdate(plot,xBuf(1:n),yBuf(1:n))
+    case (2)
+      xBuf(1:n)=parts(1:n)%x
+      yBuf(1:n)=parts(1:n)%y
+      frame=qdspUpdate(plot,c_loc(xBuf),c_loc(yBuf),c_null_ptr,int(n,c_int))
+    case (3)
+      frame=qdspUpdate(plot,parts(1:n)%x,parts(1:n)%y)
+    case default
+      frame=qdspUpdate(plot,parts32(1:n)%x,parts32(1:n)%y)
+    end select
+  end function
+
+end program
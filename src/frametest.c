@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glad/glad.h"
+#include "qdsp.h"
+
+// Checks frames written with qdspFrameSlice, built and run by 'make test'.
+//
+// A frame that qdspEndFrame doesn't upload, because the plot is frozen or
+// over its overhead budget, has to leave the plot as it was, even when it has
+// fewer points than what's on screen. While a frame is written into the point
+// buffers, nothing may draw from them. Exits nonzero if any check fails.
+
+#define WIDTH 800
+#define HEIGHT 600
+#define NUM_POINTS 200000
+#define FRAME_POINTS 1000
+
+static unsigned char before[WIDTH * HEIGHT * 4], after[WIDTH * HEIGHT * 4];
+static int failures = 0;
+
+static void check(int ok, const char *what) {
+	printf("%s: %s\n", ok ? "ok" : "FAIL", what);
+	if (!ok)
+		failures++;
+}
+
+// forces a full redraw and reads back what's on screen
+static void grab(QDSPplot *plot, unsigned char *pixels) {
+	qdspSetBounds(plot, -1, 1, -1, 1);
+	qdspRedraw(plot);
+	glReadBuffer(GL_BACK);
+	glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+}
+
+// every point of a frame in one corner, so a frame that got through shows
+static int writeFrame(QDSPplot *plot, size_t numPoints) {
+	if (!qdspBeginFrame(plot, numPoints, 1))
+		return -1;
+
+	QDSPslice slice = qdspFrameSlice(plot, 0, numPoints);
+	for (size_t i = 0; i < numPoints; i++) {
+		slice.x[i] = 0.9;
+		slice.y[i] = 0.9;
+		slice.color[i] = 0xffffff;
+	}
+	return qdspEndFrame(plot);
+}
+
+int main(void) {
+	double *x = malloc(NUM_POINTS * sizeof(double));
+	double *y = malloc(NUM_POINTS * sizeof(double));
+	int *color = malloc(NUM_POINTS * sizeof(int));
+	if (x == NULL || y == NULL || color == NULL) {
+		fprintf(stderr, "Couldn't allocate points\n");
+		return 1;
+	}
+
+	srand(1);
+	for (int i = 0; i < NUM_POINTS; i++) {
+		x[i] = 1.6 * rand() / RAND_MAX - 0.8;
+		y[i] = 1.6 * rand() / RAND_MAX - 0.8;
+		color[i] = rand() & 0xffffff;
+	}
+
+	QDSPplot *plot = qdspInit("QDSP frame test");
+	if (plot == NULL)
+		return 1;
+	qdspSetFramerate(plot, 0);
+	qdspUpdate(plot, x, y, color, NUM_POINTS);
+	grab(plot, before);
+
+	// frozen: the frame is dropped
+	plot->frozen = 1;
+	int result = writeFrame(plot, FRAME_POINTS);
+	plot->frozen = 0;
+	grab(plot, after);
+	check(result == 2, "frozen frame is dropped");
+	check(plot->numPoints == NUM_POINTS, "frozen frame keeps the points");
+	check(memcmp(before, after, sizeof(before)) == 0, "frozen frame keeps the picture");
+
+	// over the overhead budget: also dropped
+	qdspSetOverheadBudget(plot, 0.5);
+	plot->budgetInterval = 1e9;
+	result = writeFrame(plot, FRAME_POINTS);
+	qdspSetOverheadBudget(plot, 0);
+	grab(plot, after);
+	check(result == 2, "frame over budget is dropped");
+	check(plot->numPoints == NUM_POINTS, "frame over budget keeps the points");
+	check(memcmp(before, after, sizeof(before)) == 0, "frame over budget keeps the picture");
+
+	// nothing draws from the point buffers while they're mapped
+	int began = qdspBeginFrame(plot, NUM_POINTS, 1);
+	check(began && plot->frameMapped, "frame is mapped");
+	qdspSetBounds(plot, -2, 2, -2, 2);
+	qdspRedraw(plot);
+	qdspPoll(plot);
+	check(plot->damage != 0 && glGetError() == GL_NO_ERROR, "no redraw from mapped buffers");
+	check(qdspUpdate(plot, x, y, color, NUM_POINTS) == 0, "update during a frame fails");
+	QDSPslice slice = qdspFrameSlice(plot, 0, NUM_POINTS);
+	memcpy(slice.x, x, NUM_POINTS * sizeof(double));
+	memcpy(slice.y, y, NUM_POINTS * sizeof(double));
+	memcpy(slice.color, color, NUM_POINTS * sizeof(int));
+	check(qdspEndFrame(plot) == 1, "mapped frame is drawn");
+	grab(plot, after);
+	check(memcmp(before, after, sizeof(before)) == 0, "mapped frame matches the arrays");
+
+	// and a smaller frame that does get through replaces them
+	check(writeFrame(plot, FRAME_POINTS) == 1, "shrinking frame is drawn");
+	check(plot->numPoints == FRAME_POINTS, "shrinking frame replaces the points");
+
+	qdspDelete(plot);
+	free(x);
+	free(y);
+	free(color);
+
+	return failures != 0;
+}
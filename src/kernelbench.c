@@ -0,0 +1,183 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <omp.h>
+
+#include "kernels.h"
+
+// Microbenchmark for QDSP's conversion kernels, built and run by
+// 'make bench-kernels'. No OpenGL is needed.
+//
+// Every kernel set supported by this CPU is timed on each kernel, at each
+// size, on one thread and on all of them (in chunks, like the upload pass).
+// Output is checked against the scalar kernels. Results are CSV.
+//
+// Usage: kernelbench [-min exp] [-max exp] [-reps n]
+
+// same as the upload pass
+#define CHUNK 8192
+
+typedef enum { RANGE, CONVERT, COPY64, PACK_COLOR, NUM_KERNELS } Kernel;
+
+static const char *KERNEL_NAMES[] = {"range", "convert", "copy64", "packColor"};
+
+// bytes read and written per element
+static const int KERNEL_BYTES[] = {8, 12, 16, 8};
+
+// bytes written per element
+static const int KERNEL_WRITES[] = {0, 4, 8, 4};
+
+static double msDiff(const struct timespec *start, const struct timespec *end) {
+	return ((double)end->tv_sec*1.0e3 + end->tv_nsec*1.0e-6) -
+		((double)start->tv_sec*1.0e3 + start->tv_nsec*1.0e-6);
+}
+
+static void runKernel(const QDSPkernels *k, Kernel kernel, int parallel, long n,
+                      const double *src, const int *colorSrc, void *dst,
+                      double *min, double *max) {
+	long numChunks = (n + CHUNK - 1) / CHUNK;
+	// decided the same way as the upload pass
+	int stream = (n * KERNEL_WRITES[kernel] >= QDSP_STREAM_MIN);
+	double lo = INFINITY, hi = -INFINITY;
+
+#pragma omp parallel if(parallel) reduction(min:lo) reduction(max:hi)
+	{
+#pragma omp for schedule(static)
+		for (long c = 0; c < numChunks; c++) {
+			long start = c * CHUNK;
+			int len = (n - start < CHUNK) ? n - start : CHUNK;
+
+			switch (kernel) {
+			case RANGE:
+				k->range(&src[start], len, &lo, &hi);
+				break;
+			case CONVERT:
+				k->convert((float*)dst + start, &src[start], len, 0.5, stream);
+				break;
+			case COPY64:
+				k->copy64((double*)dst + start, &src[start], len, stream);
+				break;
+			case PACK_COLOR:
+				k->packColor((int*)dst + start, &colorSrc[start], len, stream);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	*min = lo;
+	*max = hi;
+}
+
+// compares against the scalar kernels, returns the largest difference
+static double check(Kernel kernel, long n, const void *dst, const void *ref,
+                    double min, double max, double refMin, double refMax) {
+	double err = 0;
+	switch (kernel) {
+	case RANGE:
+		err = fmax(fabs(min - refMin), fabs(max - refMax));
+		break;
+	case CONVERT:
+		for (long i = 0; i < n; i++)
+			err = fmax(err, fabs(((float*)dst)[i] - ((float*)ref)[i]));
+		break;
+	case COPY64:
+		err = memcmp(dst, ref, n * sizeof(double)) != 0;
+		break;
+	case PACK_COLOR:
+		err = memcmp(dst, ref, n * sizeof(int)) != 0;
+		break;
+	default:
+		break;
+	}
+	return err;
+}
+
+int main(int argc, char **argv) {
+	int minExp = 4, maxExp = 7;
+	int reps = 20;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-min") && i + 1 < argc) minExp = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-max") && i + 1 < argc) maxExp = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "-reps") && i + 1 < argc) reps = atoi(argv[++i]);
+		else {
+			fprintf(stderr, "Usage: %s [-min exp] [-max exp] [-reps n]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (reps < 1) reps = 1;
+
+	long maxN = lround(pow(10, maxExp));
+	double *src = malloc(maxN * sizeof(double));
+	int *colorSrc = malloc(maxN * sizeof(int));
+	void *dst = NULL, *ref = NULL;
+	if (posix_memalign(&dst, 64, maxN * sizeof(double)) != 0) dst = NULL;
+	if (posix_memalign(&ref, 64, maxN * sizeof(double)) != 0) ref = NULL;
+	if (src == NULL || colorSrc == NULL || dst == NULL || ref == NULL) {
+		fprintf(stderr, "Could not allocate %ld elements\n", maxN);
+		return 1;
+	}
+
+	srand(1);
+	for (long i = 0; i < maxN; i++) {
+		src[i] = 1.0e6 * rand() / RAND_MAX;
+		colorSrc[i] = rand();
+	}
+
+	const QDSPkernels *scalar = qdspKernelsByName("scalar");
+	const char *names[] = {"scalar", "avx2", "avx512", "neon"};
+
+	printf("kernels,kernel,elements,threads,msMean,msMin,GBPerSec,nsPerElement,maxError\n");
+
+	for (int e = minExp; e <= maxExp; e++) {
+		long n = lround(pow(10, e));
+
+		for (Kernel kernel = 0; kernel < NUM_KERNELS; kernel++) {
+			double refMin, refMax;
+			runKernel(scalar, kernel, 0, n, src, colorSrc, ref, &refMin, &refMax);
+
+			for (int s = 0; s < 4; s++) {
+				const QDSPkernels *k = qdspKernelsByName(names[s]);
+				if (k == NULL)
+					continue;
+
+				for (int parallel = 0; parallel < 2; parallel++) {
+					double min, max;
+					// warm up, and make sure the results are right
+					runKernel(k, kernel, parallel, n, src, colorSrc, dst, &min, &max);
+					double err = check(kernel, n, dst, ref, min, max, refMin, refMax);
+
+					double total = 0, best = INFINITY;
+					for (int r = 0; r < reps; r++) {
+						struct timespec start, end;
+						clock_gettime(CLOCK_MONOTONIC, &start);
+						runKernel(k, kernel, parallel, n, src, colorSrc, dst, &min, &max);
+						clock_gettime(CLOCK_MONOTONIC, &end);
+
+						double ms = msDiff(&start, &end);
+						total += ms;
+						if (ms < best) best = ms;
+					}
+
+					printf("%s,%s,%ld,%d,%.4f,%.4f,%.3f,%.4f,%g\n",
+					       k->name, KERNEL_NAMES[kernel], n,
+					       parallel ? omp_get_max_threads() : 1,
+					       total / reps, best,
+					       1.0e-6 * KERNEL_BYTES[kernel] * n / best,
+					       1.0e6 * best / n, err);
+				}
+			}
+		}
+	}
+
+	free(src);
+	free(colorSrc);
+	free(dst);
+	free(ref);
+
+	return 0;
+}
@@ -0,0 +1,313 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define QDSP_X86
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define QDSP_NEON
+#endif
+
+// scalar versions, which the compiler can still vectorize for the baseline ISA
+
+static void rangeScalar(const double *src, int len, double *min, double *max) {
+	double lo = *min, hi = *max;
+#pragma omp simd reduction(min:lo) reduction(max:hi)
+	for (int i = 0; i < len; i++) {
+		lo = src[i] < lo ? src[i] : lo;
+		hi = src[i] > hi ? src[i] : hi;
+	}
+	*min = lo;
+	*max = hi;
+}
+
+// these ignore stream; plain C can't ask for non-temporal stores
+
+static void convertScalar(float *dst, const double *src, int len, double origin, int stream) {
+	(void)stream;
+#pragma omp simd
+	for (int i = 0; i < len; i++)
+		dst[i] = (float)(src[i] - origin);
+}
+
+static void copy64Scalar(double *dst, const double *src, int len, int stream) {
+	(void)stream;
+	memcpy(dst, src, len * sizeof(double));
+}
+
+static void packColorScalar(int *dst, const int *src, int len, int stream) {
+	(void)stream;
+#pragma omp simd
+	for (int i = 0; i < len; i++)
+		dst[i] = src[i] & 0xffffff;
+}
+
+static const QDSPkernels SCALAR = {
+	"scalar", rangeScalar, convertScalar, copy64Scalar, packColorScalar
+};
+
+// number of elements of the given size before dst is aligned to align bytes
+static int headLength(const void *dst, int size, int align, int len) {
+	int head = ((align - (uintptr_t)dst % align) % align) / size;
+	if ((uintptr_t)dst % size != 0 || head > len)
+		return len; // can't ever be aligned, do it all the slow way
+	return head;
+}
+
+#ifdef QDSP_X86
+
+// AVX2: 4 doubles at a time, with non-temporal 32-byte stores when streaming
+
+__attribute__((target("avx2")))
+static void rangeAVX2(const double *src, int len, double *min, double *max) {
+	__m256d lo = _mm256_set1_pd(*min), hi = _mm256_set1_pd(*max);
+	int i = 0;
+	for (; i + 4 <= len; i += 4) {
+		__m256d v = _mm256_loadu_pd(&src[i]);
+		// the second operand is returned for NaNs, so they're ignored
+		lo = _mm256_min_pd(v, lo);
+		hi = _mm256_max_pd(v, hi);
+	}
+
+	double l[4], h[4];
+	_mm256_storeu_pd(l, lo);
+	_mm256_storeu_pd(h, hi);
+	for (int j = 0; j < 4; j++) {
+		if (l[j] < *min) *min = l[j];
+		if (h[j] > *max) *max = h[j];
+	}
+	rangeScalar(&src[i], len - i, min, max);
+}
+
+__attribute__((target("avx2")))
+static void convertAVX2(float *dst, const double *src, int len, double origin, int stream) {
+	int i = headLength(dst, sizeof(float), 32, len);
+	convertScalar(dst, src, i, origin, stream);
+
+	__m256d o = _mm256_set1_pd(origin);
+	for (; i + 8 <= len; i += 8) {
+		__m128 a = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(&src[i]), o));
+		__m128 b = _mm256_cvtpd_ps(_mm256_sub_pd(_mm256_loadu_pd(&src[i+4]), o));
+		__m256 ab = _mm256_insertf128_ps(_mm256_castps128_ps256(a), b, 1);
+		if (stream)
+			_mm256_stream_ps(&dst[i], ab);
+		else
+			_mm256_store_ps(&dst[i], ab);
+	}
+	if (stream)
+		_mm_sfence();
+
+	convertScalar(&dst[i], &src[i], len - i, origin, stream);
+}
+
+__attribute__((target("avx2")))
+static void copy64AVX2(double *dst, const double *src, int len, int stream) {
+	// memcpy's already as fast as it gets through the cache
+	if (!stream) {
+		copy64Scalar(dst, src, len, stream);
+		return;
+	}
+
+	int i = headLength(dst, sizeof(double), 32, len);
+	copy64Scalar(dst, src, i, stream);
+
+	for (; i + 4 <= len; i += 4)
+		_mm256_stream_pd(&dst[i], _mm256_loadu_pd(&src[i]));
+	_mm_sfence();
+
+	copy64Scalar(&dst[i], &src[i], len - i, stream);
+}
+
+__attribute__((target("avx2")))
+static void packColorAVX2(int *dst, const int *src, int len, int stream) {
+	int i = headLength(dst, sizeof(int), 32, len);
+	packColorScalar(dst, src, i, stream);
+
+	__m256i mask = _mm256_set1_epi32(0xffffff);
+	for (; i + 8 <= len; i += 8) {
+		__m256i v = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)&src[i]), mask);
+		if (stream)
+			_mm256_stream_si256((__m256i*)&dst[i], v);
+		else
+			_mm256_store_si256((__m256i*)&dst[i], v);
+	}
+	if (stream)
+		_mm_sfence();
+
+	packColorScalar(&dst[i], &src[i], len - i, stream);
+}
+
+static const QDSPkernels AVX2 = {
+	"avx2", rangeAVX2, convertAVX2, copy64AVX2, packColorAVX2
+};
+
+// AVX-512: 8 doubles at a time, with non-temporal 64-byte stores when streaming
+
+__attribute__((target("avx512f")))
+static void rangeAVX512(const double *src, int len, double *min, double *max) {
+	__m512d lo = _mm512_set1_pd(*min), hi = _mm512_set1_pd(*max);
+	int i = 0;
+	for (; i + 8 <= len; i += 8) {
+		__m512d v = _mm512_loadu_pd(&src[i]);
+		lo = _mm512_min_pd(v, lo);
+		hi = _mm512_max_pd(v, hi);
+	}
+
+	*min = _mm512_reduce_min_pd(lo);
+	*max = _mm512_reduce_max_pd(hi);
+	rangeScalar(&src[i], len - i, min, max);
+}
+
+__attribute__((target("avx512f")))
+static void convertAVX512(float *dst, const double *src, int len, double origin, int stream) {
+	int i = headLength(dst, sizeof(float), 64, len);
+	convertScalar(dst, src, i, origin, stream);
+
+	__m512d o = _mm512_set1_pd(origin);
+	for (; i + 16 <= len; i += 16) {
+		__m256 a = _mm512_cvtpd_ps(_mm512_sub_pd(_mm512_loadu_pd(&src[i]), o));
+		__m256 b = _mm512_cvtpd_ps(_mm512_sub_pd(_mm512_loadu_pd(&src[i+8]), o));
+		__m512 ab = _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castpd256_pd512(_mm256_castps_pd(a)),
+		                                                _mm256_castps_pd(b), 1));
+		if (stream)
+			_mm512_stream_ps(&dst[i], ab);
+		else
+			_mm512_store_ps(&dst[i], ab);
+	}
+	if (stream)
+		_mm_sfence();
+
+	convertScalar(&dst[i], &src[i], len - i, origin, stream);
+}
+
+__attribute__((target("avx512f")))
+static void copy64AVX512(double *dst, const double *src, int len, int stream) {
+	if (!stream) {
+		copy64Scalar(dst, src, len, stream);
+		return;
+	}
+
+	int i = headLength(dst, sizeof(double), 64, len);
+	copy64Scalar(dst, src, i, stream);
+
+	for (; i + 8 <= len; i += 8)
+		_mm512_stream_pd(&dst[i], _mm512_loadu_pd(&src[i]));
+	_mm_sfence();
+
+	copy64Scalar(&dst[i], &src[i], len - i, stream);
+}
+
+__attribute__((target("avx512f")))
+static void packColorAVX512(int *dst, const int *src, int len, int stream) {
+	int i = headLength(dst, sizeof(int), 64, len);
+	packColorScalar(dst, src, i, stream);
+
+	__m512i mask = _mm512_set1_epi32(0xffffff);
+	for (; i + 16 <= len; i += 16) {
+		__m512i v = _mm512_and_si512(_mm512_loadu_si512(&src[i]), mask);
+		if (stream)
+			_mm512_stream_si512((__m512i*)&dst[i], v);
+		else
+			_mm512_store_si512((__m512i*)&dst[i], v);
+	}
+	if (stream)
+		_mm_sfence();
+
+	packColorScalar(&dst[i], &src[i], len - i, stream);
+}
+
+static const QDSPkernels AVX512 = {
+	"avx512", rangeAVX512, convertAVX512, copy64AVX512, packColorAVX512
+};
+
+#endif
+
+#ifdef QDSP_NEON
+
+// NEON: 2 doubles at a time; there are no non-temporal store intrinsics, so
+// these just use regular stores and ignore stream
+
+static void rangeNEON(const double *src, int len, double *min, double *max) {
+	float64x2_t lo = vdupq_n_f64(*min), hi = vdupq_n_f64(*max);
+	int i = 0;
+	for (; i + 2 <= len; i += 2) {
+		float64x2_t v = vld1q_f64(&src[i]);
+		// the nm versions ignore NaNs
+		lo = vminnmq_f64(v, lo);
+		hi = vmaxnmq_f64(v, hi);
+	}
+
+	*min = vminnmvq_f64(lo);
+	*max = vmaxnmvq_f64(hi);
+	rangeScalar(&src[i], len - i, min, max);
+}
+
+static void convertNEON(float *dst, const double *src, int len, double origin, int stream) {
+	float64x2_t o = vdupq_n_f64(origin);
+	int i = 0;
+	for (; i + 4 <= len; i += 4) {
+		float32x2_t a = vcvt_f32_f64(vsubq_f64(vld1q_f64(&src[i]), o));
+		float32x2_t b = vcvt_f32_f64(vsubq_f64(vld1q_f64(&src[i+2]), o));
+		vst1q_f32(&dst[i], vcombine_f32(a, b));
+	}
+
+	convertScalar(&dst[i], &src[i], len - i, origin, stream);
+}
+
+static void packColorNEON(int *dst, const int *src, int len, int stream) {
+	int32x4_t mask = vdupq_n_s32(0xffffff);
+	int i = 0;
+	for (; i + 4 <= len; i += 4)
+		vst1q_s32(&dst[i], vandq_s32(vld1q_s32(&src[i]), mask));
+
+	packColorScalar(&dst[i], &src[i], len - i, stream);
+}
+
+static const QDSPkernels NEON = {
+	"neon", rangeNEON, convertNEON, copy64Scalar, packColorNEON
+};
+
+#endif
+
+const QDSPkernels *qdspKernelsByName(const char *name) {
+	if (!strcmp(name, "scalar"))
+		return &SCALAR;
+
+#ifdef QDSP_X86
+	__builtin_cpu_init();
+	if (!strcmp(name, "avx2") && __builtin_cpu_supports("avx2"))
+		return &AVX2;
+	if (!strcmp(name, "avx512") && __builtin_cpu_supports("avx512f"))
+		return &AVX512;
+#endif
+
+#ifdef QDSP_NEON
+	if (!strcmp(name, "neon"))
+		return &NEON;
+#endif
+
+	return NULL;
+}
+
+const QDSPkernels *qdspKernels(void) {
+	static const QDSPkernels *best = NULL;
+	if (best != NULL)
+		return best;
+
+	// let people pick, for benchmarking or working around a bad CPU
+	const char *env = getenv("QDSP_KERNELS");
+	if (env != NULL)
+		best = qdspKernelsByName(env);
+
+	const char *order[] = {"avx512", "avx2", "neon", "scalar"};
+	for (int i = 0; best == NULL && i < 4; i++)
+		best = qdspKernelsByName(order[i]);
+
+	return best;
+}
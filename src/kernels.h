@@ -0,0 +1,44 @@
+/*
+ * Internal conversion kernels for QDSP.
+ *
+ * These are the inner loops of the upload pass: finding the data range,
+ * converting doubles to float offsets, and streaming data into mapped
+ * buffers. Each kernel works on a single chunk; threading is up to the caller,
+ * and so is deciding whether the stores should bypass the cache, since only
+ * the caller knows how much is written in all.
+ * There's a scalar version of everything, plus AVX2 and AVX-512 versions on
+ * x86 and NEON versions on ARM, picked at runtime.
+ */
+
+#ifndef _QDSP_KERNELS_H
+#define _QDSP_KERNELS_H
+
+typedef struct QDSPkernels {
+	const char *name;
+
+	// folds the min and max of src into *min and *max, ignoring NaNs
+	void (*range)(const double *src, int len, double *min, double *max);
+
+	// dst = (float)(src - origin)
+	void (*convert)(float *dst, const double *src, int len, double origin, int stream);
+
+	// dst = src
+	void (*copy64)(double *dst, const double *src, int len, int stream);
+
+	// dst = src & 0xffffff, dropping the unused byte of each color
+	void (*packColor)(int *dst, const int *src, int len, int stream);
+} QDSPkernels;
+
+// with stream set, the kernels above bypass the cache if they can. That only
+// pays off once a pass writes more than the cache holds; below this many bytes
+// in all, non-temporal stores are slower than regular ones
+#define QDSP_STREAM_MIN (4 << 20)
+
+// fastest kernels for this CPU, or the ones named by $QDSP_KERNELS
+const QDSPkernels *qdspKernels(void);
+
+// kernels with the given name ("scalar", "avx2", "avx512", or "neon"), or NULL
+// if they aren't supported on this CPU
+const QDSPkernels *qdspKernelsByName(const char *name);
+
+#endif
@@ -1,39 +1,470 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
 #include <time.h>
 #include <omp.h>
+#include <pthread.h>
+#include <sched.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "glad/glad.h"
 #include <GLFW/glfw3.h>
 #include <SOIL/SOIL.h>
 
 #include "qdsp.h"
+#include "kernels.h"
+
+// HUD layout: rows of numbers to the right of the labels in images/hud.png,
+// with the frame-time graph along the bottom of the image
+#define HUD_ROWS 6
+#define HUD_LABEL_CHARS 6
+#define HUD_CHARS 10
+#define HUD_GRAPH_PIXELS 60
+
+// how often stats (and the HUD) are refreshed, in ms
+#define STATS_INTERVAL 250.0
+
+// more gridlines than this and we start skipping some
+#define GRID_MAX_LINES 32
+
+// characters per grid label, and room for the most labels we could draw
+#define GRID_LABEL_CHARS 10
+#define GRID_MAX_LABELS (GRID_MAX_LINES + 2)
+
+// the font atlas in images/ascii.png has every printable ASCII character
+#define ATLAS_FIRST ' '
+#define ATLAS_CHARS 95
+
+// zoom factor for one click of the scroll wheel
+#define ZOOM_STEP 1.2
+
+// automatic bounds: margin, percentile cut, histogram size, smallest change
+// worth moving the view for, and how small the data gets before expand mode
+// shrinks (all fractions of the plot span)
+#define AUTO_PAD 0.05
+#define AUTO_PERCENTILE 0.005
+#define AUTO_BINS 1024
+#define AUTO_DEADBAND 0.02
+#define AUTO_SHRINK 0.5
+
+// points per chunk for the upload pass, small enough to stay in cache
+#define UPLOAD_CHUNK 8192
+
+// spatial sort: tile size in pixels, bits of tile coordinate per axis (keys
+// are twice this, sorted in two radix passes), the fewest points worth sorting,
+// and the fraction of neighbours out of order before the order is redone
+#define SORT_TILE 8
+#define SORT_BITS 11
+#define SORT_MIN_POINTS (1 << 16)
+#define SORT_SLACK 0.05
+
+// most bytes in one point buffer; drivers limit the size of a buffer (often to
+// 1 or 2 GiB), so more points than fit are split across several
+#define SEGMENT_BYTES (1 << 30)
+
+// points per chunk streamed from a file, each through one of the stream
+// buffers; the GPU side of a stream is QDSP_STREAM_BUFFERS of these
+#define STREAM_CHUNK (1 << 20)
+
+// how long to wait on a stream buffer in one go, in nanoseconds
+#define STREAM_WAIT 100000000
+
+// in high precision mode, how many view widths the view can drift from the
+// origin before we move the origin (float offsets are still sub-pixel)
+#define RECENTER_SPANS 64.0
+
+// overhead budget: the slowest framerate we drop frames down to before
+// thinning out points instead, and the most points thinned to one
+#define BUDGET_MIN_FPS 10.0
+#define BUDGET_MAX_STRIDE 64
+
+// hover picking finds the nearest point within this many pixels
+#define PICK_RADIUS 4
+#define PICK_SIZE (2 * PICK_RADIUS + 1)
+
+// selected points are drawn this many pixels bigger, under the points
+#define HIGHLIGHT_PIXELS 4
+#define HIGHLIGHT_COLOR 0xff33ff
+
+// lasso vertices closer together than this, in pixels, are dropped
+#define LASSO_SPACING 3.0
+
+// what changed since a panel was drawn; with none of it, redraws are skipped
+// and the last frame stays on screen
+#define DAMAGE_DATA 1
+#define DAMAGE_UNIFORMS 2
+#define DAMAGE_GRID 4
+#define DAMAGE_OVERLAY 8
+#define DAMAGE_ALL 15
+
+// commands for the render thread, see qdspInitThreaded
+#define CMD_INIT 0
+#define CMD_DELETE 1
+#define CMD_REDRAW 2
+#define CMD_GET_STATS 3
+#define CMD_UPDATE 4
+#define CMD_UPDATE_IF_READY 5
+#define CMD_UPDATE_WAIT 6
+#define CMD_UPDATE_CURVES 7
+#define CMD_SET_FRAMERATE 8
+#define CMD_SET_BOUNDS 9
+#define CMD_SET_AUTO_BOUNDS 10
+#define CMD_SET_HIGH_PRECISION 11
+#define CMD_SET_TEXT 12
+#define CMD_SET_PERSISTENCE 13
+#define CMD_SET_TRAILS 14
+#define CMD_SET_CONNECTED 15
+#define CMD_SET_LINE_STYLE 16
+#define CMD_SET_POINT_SIZE 17
+#define CMD_SET_POINT_ALPHA 18
+#define CMD_SET_POINT_COLOR 19
+#define CMD_SET_BG_COLOR 20
+#define CMD_SET_GRID_X 21
+#define CMD_SET_GRID_Y 22
+#define CMD_SET_OVERHEAD_BUDGET 23
+#define CMD_SET_HOVER_CALLBACK 24
+#define CMD_SET_SELECT_CALLBACK 25
+#define CMD_UPDATE_FILTER 26
+#define CMD_SET_FILTER_RANGE 27
+#define CMD_SET_FILTER_CLASSES 28
+#define CMD_UPDATE_FILE 29
+#define CMD_SET_SPATIAL_SORT 30
+#define CMD_BEGIN_FRAME 31
+#define CMD_END_FRAME 32
+#define CMD_SET_BLEND_MODE 33
+#define CMD_SET_GRID_VISIBLE 34
+
+// how long the render thread waits for events between commands, in seconds
+#define RENDER_POLL 0.01
+
+// a caller waiting for a command, on its own stack
+typedef struct QDSPwaiter {
+	int done;
+	int result;
+	void *value;
+} QDSPwaiter;
+
+// a call for the render thread, with its arguments; update arrays are the
+// caller's, and are only read until the command is finished
+typedef struct QDSPcommand {
+	struct QDSPcommand *next;
+	int kind;
+	QDSPplot *plot;
+
+	int i[2];
+	double d[4];
+	char *text;
+
+	QDSParray arrays[3];
+	int hasColor;
+	size_t numPoints;
+	int *curves[3];
+	int numCurves;
+	const QDSPcolumn *columns[3];
+	long long numRows;
+
+	QDSPhoverCallback hover;
+	QDSPselectCallback select;
+	void *data;
+
+	long long ticket; // async updates
+	QDSPwaiter *waiter; // synchronous calls
+	QDSPstats *stats;
+} QDSPcommand;
+
+// threaded plots are run by one render thread, since GLFW isn't thread safe.
+// Commands reach it through a lock-free queue (a Vyukov MPSC list: producers
+// swap themselves in at the tail, and the consumer keeps the last command it
+// took as the head), and it's woken with an empty GLFW event.
+static pthread_t renderThread;
+static int renderRunning = 0;
+
+// held while the render thread is started or shut down, so two threads can't
+// both start one, or start one while another's being joined
+static pthread_mutex_t startLock = PTHREAD_MUTEX_INITIALIZER;
+static QDSPcommand renderStub;
+static QDSPcommand *queueHead = &renderStub;
+static QDSPcommand *queueTail = &renderStub;
+
+// set by the render thread: GLFW is up, so producers can post empty events,
+// and the thread is gone, so nothing more can be queued. Producers count
+// themselves in pushers while they act on these, and the render thread waits
+// for them before shutting GLFW down
+static int glfwLive = 0;
+static int queueClosed = 0;
+static int pushers = 0;
+
+// render thread only: the command being run, and windows to poll while idle
+static QDSPcommand *renderCommand = NULL;
+static QDSPplot **renderPlots = NULL;
+static int numRenderPlots = 0;
+
+// finished commands and tickets; tickets finished ahead of one that was
+// queued late by a racing thread wait in ticketsAhead
+static pthread_mutex_t renderLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t renderDone = PTHREAD_COND_INITIALIZER;
+static long long ticketsIssued = 0;
+static long long ticketsDone = 0;
+static long long *ticketsAhead = NULL;
+static int numAhead = 0, aheadCapacity = 0;
 
 static void closeCallback(GLFWwindow *window);
 
 static void resizeCallback(GLFWwindow *window, int width, int height);
 
+static void iconifyCallback(GLFWwindow *window, int iconified);
+
+static void refreshCallback(GLFWwindow *window);
+
 static void keyCallback(GLFWwindow *window, int key, int code, int action, int mods);
 
-static int makeShader(const char *filename, GLenum type);
+static void scrollCallback(GLFWwindow *window, double xoffset, double yoffset);
+
+static void cursorCallback(GLFWwindow *window, double xpos, double ypos);
+
+static void mouseCallback(GLFWwindow *window, int button, int action, int mods);
+
+static int initPanel(QDSPplot *plot, const char *title);
+
+static void freePanel(QDSPplot *plot);
+
+static void drawPanel(QDSPplot *plot);
+
+static void resizePanel(QDSPplot *plot, int x, int y, int width, int height);
+
+static int windowDirty(QDSPplot *plot);
+
+static void damageWindow(QDSPplot *plot, int damage);
+
+static int allUpdated(QDSPplot *plot);
+
+static void moveCursor(QDSPplot *plot, double xpos, double ypos);
+
+static void panelSize(QDSPplot *plot, double *width, double *height);
+
+static void addLasso(QDSPplot *plot, double xpos, double ypos);
+
+static void clearSelection(QDSPplot *plot);
+
+static void servicePicks(QDSPplot *plot);
+
+static void pickPass(QDSPplot *plot);
+
+static void readPick(QDSPplot *plot);
+
+static void selectPass(QDSPplot *plot);
+
+static void readSelection(QDSPplot *plot);
+
+static void hoverPoint(QDSPplot *plot, int index);
+
+static int fenceDone(void *fence);
+
+static int makeShader(const char *filename, GLenum type, int filtered);
+
+static char *readShader(const char *filename, int *size);
 
 static int loadTexture(const char *relpath, int *width, int *height);
 
 static void resourcePath(char *fullpath, const char *relpath);
 
-static void charHelper(float *addr, float x0, float y0, int xoff, int yoff, char ch);
+static void drawPoints(QDSPplot *plot);
+
+static void drawPersistent(QDSPplot *plot);
+
+static void drawSelection(QDSPplot *plot);
+
+static void resizePersistent(QDSPplot *plot);
+
+static void resizeTarget(QDSPplot *plot, unsigned int *fbo, unsigned int *texture);
+
+static void initStream(QDSPplot *plot);
+
+static void endStream(QDSPplot *plot);
+
+static void drawStream(QDSPplot *plot, int restream);
+
+static void streamFile(QDSPplot *plot);
+
+static void adviseRows(QDSPplot *plot, long long start, long long len, int advice);
+
+// one instance of the text program: a character cell anchored at x, y (in
+// normalized device coordinates) and offset by col, row cells
+struct QDSPglyph {
+	float x, y;
+	short col, row;
+	unsigned short ch;
+	unsigned short unused;
+};
+
+// a buffer's worth of points: segment k holds the points from
+// k * (segmentPoints - segmentOverlap) on, with x and y also readable through
+// texture buffers for highlighting the selection
+struct QDSPsegment {
+	unsigned int vao;
+	unsigned int vbos[3];
+	unsigned int textures[2];
+};
+
+static void initSegment(QDSPplot *plot, struct QDSPsegment *seg);
+
+static int splitPoints(QDSPplot *plot, size_t numPoints);
+
+static size_t segmentBase(QDSPplot *plot, int k);
+
+static size_t segmentSize(QDSPplot *plot, int k);
+
+static int segmentIndex(QDSPplot *plot, int k);
+
+static void drawCurveSegments(QDSPplot *plot);
+
+static void glyphHelper(struct QDSPglyph *glyph, float x, float y, int col, int row, char ch);
+
+static void updateText(QDSPplot *plot);
+
+static void updateStats(QDSPplot *plot);
+
+static void updateHud(QDSPplot *plot);
+
+static void formatHud(char *str, double value);
+
+static double msDiff(const struct timespec *start, const struct timespec *end);
+
+static void setView(QDSPplot *plot, double xMin, double xMax, double yMin, double yMax);
+
+static void buildGridX(QDSPplot *plot);
+
+static void buildGridY(QDSPplot *plot);
+
+static int gridLines(double point, double interval, double min, double max,
+                     double *first, double *step);
+
+static void setViewUniforms(QDSPplot *plot);
+
+static void setFilterUniforms(QDSPplot *plot);
+
+static void bindFilter(QDSPplot *plot);
+
+static int updatePlot(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                      const QDSParray *color, size_t numPoints,
+                      int *starts, int *counts, int *curveColors, int numCurves);
+
+static int gateUpdate(QDSPplot *plot);
+
+static void setPointUniforms(QDSPplot *plot, int useCustom);
+
+static int frameMapped(QDSPplot *plot);
+
+static double msSinceUpdate(QDSPplot *plot);
+
+static void governOverhead(QDSPplot *plot, const struct timespec *enter);
+
+static int windowClosed(QDSPplot *plot);
+
+static int checkArray(QDSParray *arr, int color);
+
+static int isPacked(const QDSParray *arr, int type);
+
+static void uploadPoints(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                         const QDSParray *color, size_t numPoints, const unsigned int *order);
+
+static void storeRun(QDSPplot *plot, void *(*dst)[3], size_t first, int len,
+                     const double *x, const double *y, const int *color, int stream);
+
+static void storePoints(QDSPplot *plot, void **dst, size_t offset, const double *x,
+                        const double *y, const int *color, int len, int stream);
+
+static const double *chunkDoubles(const QDSParray *arr, ptrdiff_t start, int len, double *scratch);
+
+static const int *chunkColors(const QDSParray *arr, ptrdiff_t start, int len, int *scratch);
+
+static void gatherDoubles(const QDSParray *arr, const unsigned int *order, int len, double *dst);
+
+static void gatherColors(const QDSParray *arr, const unsigned int *order, int len, int *dst);
+
+static const unsigned int *sortPoints(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                                      size_t numPoints);
+
+static void radixPass(const unsigned int *keys, const unsigned int *order, unsigned int *keysOut,
+                      unsigned int *orderOut, size_t n, int shift, size_t *counts);
+
+static unsigned int spreadBits(unsigned int v);
+
+static void unsortSelection(QDSPplot *plot, int stride);
+
+static int uploadCurves(QDSPplot *plot, int *starts, int *counts, int *colors, int numCurves);
+
+static void chunkHistogram(const double *src, int len, double lo, double scale, long long *hist);
+
+static void recenter(QDSPplot *plot);
+
+static void pushTrail(QDSPplot *plot);
+
+static void percentileRange(const long long *hist, size_t count, double lo, double hi,
+                            double *pLo, double *pHi);
+
+static void fitBounds(QDSPplot *plot, const double *range);
+
+static int offThread(QDSPplot *plot);
+
+static int postCommand(const QDSPcommand *cmd, QDSPwaiter *waiter);
+
+static int pushCommand(QDSPcommand *cmd);
+
+static void stopPushers(int closeQueue);
+
+static QDSPcommand *popCommand(void);
+
+static int runCommand(QDSPcommand *cmd);
+
+static void finishCommand(int result);
+
+static void finishTicket(long long ticket);
+
+static void *renderLoop(void *arg);
 
 QDSPplot *qdspInit(const char *title) {
-	QDSPplot *plot = malloc(sizeof(QDSPplot));
+	QDSPplot **panels = qdspInitGrid(title, 1, 1);
+	return panels == NULL ? NULL : panels[0];
+}
+
+QDSPplot *qdspInitThreaded(const char *title) {
+	QDSPplot **panels = qdspInitGridThreaded(title, 1, 1);
+	return panels == NULL ? NULL : panels[0];
+}
+
+QDSPplot **qdspInitGridThreaded(const char *title, int rows, int cols) {
+	pthread_mutex_lock(&startLock);
+	if (!renderRunning) {
+		__atomic_store_n(&queueClosed, 0, __ATOMIC_SEQ_CST);
+		if (pthread_create(&renderThread, NULL, renderLoop, NULL) != 0) {
+			fprintf(stderr, "Couldn't start the render thread\n");
+			pthread_mutex_unlock(&startLock);
+			return NULL;
+		}
+		renderRunning = 1;
+	}
+
+	// the window is made by the thread that handles its events
+	QDSPcommand cmd = {.kind = CMD_INIT, .i = {rows, cols}, .text = (char*)title};
+	QDSPwaiter waiter;
+	postCommand(&cmd, &waiter);
+	pthread_mutex_unlock(&startLock);
+	return waiter.value;
+}
+
+QDSPplot **qdspInitGrid(const char *title, int rows, int cols) {
+	if (rows < 1 || cols < 1) {
+		fprintf(stderr, "A grid needs at least one row and one column\n");
+		return NULL;
+	}
 
-	// store base title so we can add status indicators later
-	int titleLen = strlen(title);
-	plot->title = malloc((titleLen + 1) * sizeof(char));
-	memcpy(plot->title, title, titleLen + 1);
-	
 	// create context
 	glfwInit();
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -41,56 +472,122 @@ QDSPplot *qdspInit(const char *title) {
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 	glfwWindowHint(GLFW_CONTEXT_RELEASE_BEHAVIOR, GLFW_RELEASE_BEHAVIOR_NONE);
 
-	// make window, basic config
-	plot->window = glfwCreateWindow(800, 600, title, NULL, NULL);
+	// make window, basic config; panels get a bit less room than a lone plot
+	int numPanels = rows * cols;
+	int width = numPanels == 1 ? 800 : 480 * cols;
+	int height = numPanels == 1 ? 600 : 360 * rows;
+	GLFWwindow *window = glfwCreateWindow(width, height, title, NULL, NULL);
 
-	if (plot->window == NULL) {
+	if (window == NULL) {
 		fprintf(stderr, "Couldn't create window\n");
 		glfwTerminate();
-		free(plot);
 		return NULL;
 	}
-	glfwMakeContextCurrent(plot->window);
-
-	// we need to get the plot in the key handler
-	glfwSetWindowUserPointer(plot->window, plot);
+	glfwMakeContextCurrent(window);
 
-	glfwSetWindowCloseCallback(plot->window, closeCallback);
-	glfwSetFramebufferSizeCallback(plot->window, resizeCallback);
-	glfwSetKeyCallback(plot->window, keyCallback);
+	glfwSetWindowCloseCallback(window, closeCallback);
+	glfwSetFramebufferSizeCallback(window, resizeCallback);
+	glfwSetWindowIconifyCallback(window, iconifyCallback);
+	glfwSetWindowRefreshCallback(window, refreshCallback);
+	glfwSetKeyCallback(window, keyCallback);
+	glfwSetScrollCallback(window, scrollCallback);
+	glfwSetCursorPosCallback(window, cursorCallback);
+	glfwSetMouseButtonCallback(window, mouseCallback);
 
 	// load extensions via GLAD
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
 		fprintf(stderr, "Couldn't initialize GLAD\n");
 		glfwTerminate();
-		free(plot);
 		return NULL;
 	}
 
+	// each panel has its own programs and buffers, so its settings can stay
+	// in uniforms, and is drawn into its own part of the window
+	QDSPplot **panels = calloc(numPanels, sizeof(QDSPplot*));
+	for (int i = 0; i < numPanels; i++) {
+		QDSPplot *plot = calloc(1, sizeof(QDSPplot));
+		plot->window = window;
+		plot->panels = panels;
+		plot->numPanels = numPanels;
+		plot->panelRow = i / cols;
+		plot->panelCol = i % cols;
+		plot->panelRows = rows;
+		plot->panelCols = cols;
+		panels[i] = plot;
+
+		if (!initPanel(plot, title)) {
+			for (int j = 0; j <= i; j++)
+				freePanel(panels[j]);
+			free(panels);
+			glfwTerminate();
+			return NULL;
+		}
+	}
+
+	// we need to get the panels in the event handlers, which start out on
+	// the first one
+	panels[0]->activePanel = panels[0];
+	glfwSetWindowUserPointer(window, panels[0]);
+
+	glfwGetFramebufferSize(window, &width, &height);
+	resizeCallback(window, width, height);
+	glfwSwapInterval(0);
+
+	return panels;
+}
+
+// sets up the programs, buffers and defaults of a plot, or one panel of a grid
+static int initPanel(QDSPplot *plot, const char *title) {
+	// store base title so we can add status indicators later
+	int titleLen = strlen(title);
+	plot->title = malloc((titleLen + 1) * sizeof(char));
+	memcpy(plot->title, title, titleLen + 1);
+
 	// create shaders and link program
 
 	// for points
-	int pointsVert = makeShader("shaders/points.vert.glsl", GL_VERTEX_SHADER);
-	int pointsFrag = makeShader("shaders/points.frag.glsl", GL_FRAGMENT_SHADER);
+	int pointsVert = makeShader("shaders/points.vert.glsl", GL_VERTEX_SHADER, 1);
+	int pointsFrag = makeShader("shaders/points.frag.glsl", GL_FRAGMENT_SHADER, 0);
+
+	// for thick lines
+	int linesVert = makeShader("shaders/lines.vert.glsl", GL_VERTEX_SHADER, 1);
+	int linesFrag = makeShader("shaders/lines.frag.glsl", GL_FRAGMENT_SHADER, 0);
 
 	// for grid
-	int gridVert = makeShader("shaders/grid.vert.glsl", GL_VERTEX_SHADER);
-	int gridFrag = makeShader("shaders/grid.frag.glsl", GL_FRAGMENT_SHADER);
+	int gridVert = makeShader("shaders/grid.vert.glsl", GL_VERTEX_SHADER, 0);
+	int gridFrag = makeShader("shaders/grid.frag.glsl", GL_FRAGMENT_SHADER, 0);
 
 	// for text
-	int textVert = makeShader("shaders/text.vert.glsl", GL_VERTEX_SHADER);
-	int textFrag = makeShader("shaders/text.frag.glsl", GL_FRAGMENT_SHADER);
+	int textVert = makeShader("shaders/text.vert.glsl", GL_VERTEX_SHADER, 0);
+	int textFrag = makeShader("shaders/text.frag.glsl", GL_FRAGMENT_SHADER, 0);
+
+	// for persistence
+	int persistVert = makeShader("shaders/persist.vert.glsl", GL_VERTEX_SHADER, 0);
+	int persistFrag = makeShader("shaders/persist.frag.glsl", GL_FRAGMENT_SHADER, 0);
+
+	// for trails
+	int trailsVert = makeShader("shaders/trails.vert.glsl", GL_VERTEX_SHADER, 1);
+	int trailsFrag = makeShader("shaders/trails.frag.glsl", GL_FRAGMENT_SHADER, 0);
 
 	// for overlay
-	int overVert = makeShader("shaders/overlay.vert.glsl", GL_VERTEX_SHADER);
-	int overFrag = makeShader("shaders/overlay.frag.glsl", GL_FRAGMENT_SHADER);
+	int overVert = makeShader("shaders/overlay.vert.glsl", GL_VERTEX_SHADER, 0);
+	int overFrag = makeShader("shaders/overlay.frag.glsl", GL_FRAGMENT_SHADER, 0);
+
+	// for picking, selection, and highlighting the selection
+	int pickVert = makeShader("shaders/pick.vert.glsl", GL_VERTEX_SHADER, 1);
+	int pickFrag = makeShader("shaders/pick.frag.glsl", GL_FRAGMENT_SHADER, 0);
+	int selectVert = makeShader("shaders/select.vert.glsl", GL_VERTEX_SHADER, 1);
+	int selectGeom = makeShader("shaders/select.geom.glsl", GL_GEOMETRY_SHADER, 0);
+	int highVert = makeShader("shaders/highlight.vert.glsl", GL_VERTEX_SHADER, 1);
 
 	// shader creation failed
-	if (pointsVert == 0 || pointsFrag == 0 || gridVert == 0 || gridFrag == 0 ||
-	    textVert == 0 || textFrag == 0 || overVert == 0 || overFrag == 0) {
-		glfwTerminate();
-		free(plot);
-		return NULL;
+	if (pointsVert == 0 || pointsFrag == 0 || linesVert == 0 || linesFrag == 0 ||
+	    gridVert == 0 || gridFrag == 0 ||
+	    textVert == 0 || textFrag == 0 || persistVert == 0 || persistFrag == 0 ||
+	    trailsVert == 0 || trailsFrag == 0 || overVert == 0 || overFrag == 0 ||
+	    pickVert == 0 || pickFrag == 0 || selectVert == 0 || selectGeom == 0 ||
+	    highVert == 0) {
+		return 0;
 	}
 
 	plot->pointsProgram = glCreateProgram();
@@ -98,6 +595,11 @@ QDSPplot *qdspInit(const char *title) {
 	glAttachShader(plot->pointsProgram, pointsFrag);
 	glLinkProgram(plot->pointsProgram);
 
+	plot->linesProgram = glCreateProgram();
+	glAttachShader(plot->linesProgram, linesVert);
+	glAttachShader(plot->linesProgram, linesFrag);
+	glLinkProgram(plot->linesProgram);
+
 	plot->textProgram = glCreateProgram();
 	glAttachShader(plot->textProgram, textVert);
 	glAttachShader(plot->textProgram, textFrag);
@@ -108,34 +610,80 @@ QDSPplot *qdspInit(const char *title) {
 	glAttachShader(plot->gridProgram, gridFrag);
 	glLinkProgram(plot->gridProgram);
 
+	plot->persistProgram = glCreateProgram();
+	glAttachShader(plot->persistProgram, persistVert);
+	glAttachShader(plot->persistProgram, persistFrag);
+	glLinkProgram(plot->persistProgram);
+
+	plot->trailsProgram = glCreateProgram();
+	glAttachShader(plot->trailsProgram, trailsVert);
+	glAttachShader(plot->trailsProgram, trailsFrag);
+	glLinkProgram(plot->trailsProgram);
+
 	plot->overlayProgram = glCreateProgram();
 	glAttachShader(plot->overlayProgram, overVert);
 	glAttachShader(plot->overlayProgram, overFrag);
 	glLinkProgram(plot->overlayProgram);
 
-	int pointSuccess, gridSuccess, textSuccess, overSuccess;
+	plot->pickProgram = glCreateProgram();
+	glAttachShader(plot->pickProgram, pickVert);
+	glAttachShader(plot->pickProgram, pickFrag);
+	glLinkProgram(plot->pickProgram);
+
+	// no fragment shader, the selected indices are all we want
+	const char *selected = "selected";
+	plot->selectProgram = glCreateProgram();
+	glAttachShader(plot->selectProgram, selectVert);
+	glAttachShader(plot->selectProgram, selectGeom);
+	glTransformFeedbackVaryings(plot->selectProgram, 1, &selected, GL_INTERLEAVED_ATTRIBS);
+	glLinkProgram(plot->selectProgram);
+
+	plot->highlightProgram = glCreateProgram();
+	glAttachShader(plot->highlightProgram, highVert);
+	glAttachShader(plot->highlightProgram, pointsFrag);
+	glLinkProgram(plot->highlightProgram);
+
+	int pointSuccess, linesSuccess, gridSuccess, textSuccess, persistSuccess;
+	int trailsSuccess, overSuccess, pickSuccess, selectSuccess, highSuccess;
 	glGetProgramiv(plot->pointsProgram, GL_LINK_STATUS, &pointSuccess);
+	glGetProgramiv(plot->linesProgram, GL_LINK_STATUS, &linesSuccess);
 	glGetProgramiv(plot->gridProgram, GL_LINK_STATUS, &gridSuccess);
 	glGetProgramiv(plot->textProgram, GL_LINK_STATUS, &textSuccess);
+	glGetProgramiv(plot->persistProgram, GL_LINK_STATUS, &persistSuccess);
+	glGetProgramiv(plot->trailsProgram, GL_LINK_STATUS, &trailsSuccess);
 	glGetProgramiv(plot->overlayProgram, GL_LINK_STATUS, &overSuccess);
-	if (!pointSuccess || !gridSuccess || !textSuccess || !overSuccess) {
+	glGetProgramiv(plot->pickProgram, GL_LINK_STATUS, &pickSuccess);
+	glGetProgramiv(plot->selectProgram, GL_LINK_STATUS, &selectSuccess);
+	glGetProgramiv(plot->highlightProgram, GL_LINK_STATUS, &highSuccess);
+	if (!pointSuccess || !linesSuccess || !gridSuccess || !textSuccess ||
+	    !persistSuccess || !trailsSuccess || !overSuccess || !pickSuccess ||
+	    !selectSuccess || !highSuccess) {
 		char log[1024];
 		glGetProgramInfoLog(plot->pointsProgram, 1024, NULL, log);
 		fprintf(stderr, "Error linking program\n");
 		fprintf(stderr, "%s\n", log);
-		glfwTerminate();
-		free(plot);
-		return NULL;
+		return 0;
 	}
 
 	glDeleteShader(pointsVert);
 	glDeleteShader(pointsFrag);
+	glDeleteShader(linesVert);
+	glDeleteShader(linesFrag);
 	glDeleteShader(gridVert);
 	glDeleteShader(gridFrag);
 	glDeleteShader(textVert);
 	glDeleteShader(textFrag);
+	glDeleteShader(persistVert);
+	glDeleteShader(persistFrag);
+	glDeleteShader(trailsVert);
+	glDeleteShader(trailsFrag);
 	glDeleteShader(overVert);
 	glDeleteShader(overFrag);
+	glDeleteShader(pickVert);
+	glDeleteShader(pickFrag);
+	glDeleteShader(selectVert);
+	glDeleteShader(selectGeom);
+	glDeleteShader(highVert);
 
 	// buffer setup for points
 	glGenVertexArrays(1, &plot->pointsVAO);
@@ -157,77 +705,107 @@ QDSPplot *qdspInit(const char *title) {
 	glVertexAttribIPointer(2, 1, GL_INT, 0, NULL);
 	glEnableVertexAttribArray(2);
 
-	// buffer setup for x grid
-	glGenVertexArrays(1, &plot->gridVAOx);
-	glGenBuffers(1, &plot->gridVBOx);
-
-	glBindVertexArray(plot->gridVAOx);
-
-	glBindBuffer(GL_ARRAY_BUFFER, plot->gridVBOx);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), NULL);
-	glEnableVertexAttribArray(0);
+	// thick lines read the point buffers (and the table of curves) through
+	// texture buffers, on texture units 1-4, so they don't have vertex data
+	glGenVertexArrays(1, &plot->linesVAO);
+	glGenBuffers(1, &plot->curvesVBO);
+	glGenTextures(4, plot->lineTextures);
+
+	glBindTexture(GL_TEXTURE_BUFFER, plot->lineTextures[0]);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, plot->pointsVBOx);
+	glBindTexture(GL_TEXTURE_BUFFER, plot->lineTextures[1]);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, plot->pointsVBOy);
+	glBindTexture(GL_TEXTURE_BUFFER, plot->lineTextures[2]);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, plot->pointsVBOrgb);
+	glBindBuffer(GL_TEXTURE_BUFFER, plot->curvesVBO);
+	glBindTexture(GL_TEXTURE_BUFFER, plot->lineTextures[3]);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, plot->curvesVBO);
+
+	// the buffers above are the first segment, and the rest are made as
+	// they're needed
+	plot->segments = malloc(sizeof(struct QDSPsegment));
+	plot->segments[0] = (struct QDSPsegment){
+		plot->pointsVAO,
+		{plot->pointsVBOx, plot->pointsVBOy, plot->pointsVBOrgb},
+		{plot->lineTextures[0], plot->lineTextures[1]}
+	};
+	plot->numSegments = 1;
+	plot->segmentCapacity = 1;
+	plot->segmentPoints = SEGMENT_BYTES / sizeof(double);
+
+	glUseProgram(plot->linesProgram);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "xBuf"), 1);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "yBuf"), 2);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "colorBuf"), 3);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "curveBuf"), 4);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "useDouble"), 1);
+
+	// trails read their ring the same way, with the current colors
+	glGenVertexArrays(1, &plot->trailsVAO);
+	glGenBuffers(2, plot->trailVBOs);
+	glGenTextures(2, plot->trailTextures);
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_TEXTURE_BUFFER, plot->trailVBOs[i]);
+		glBindTexture(GL_TEXTURE_BUFFER, plot->trailTextures[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32UI, plot->trailVBOs[i]);
+	}
 
-	// buffer setup for y grid
-	glGenVertexArrays(1, &plot->gridVAOy);
-	glGenBuffers(1, &plot->gridVBOy);
+	glUseProgram(plot->trailsProgram);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "xRing"), 1);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "yRing"), 2);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "colorBuf"), 3);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "useDouble"), 1);
 
-	glBindVertexArray(plot->gridVAOy);
+	// past this, we fall back to 1px line strips
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &plot->maxLinePoints);
 
-	glBindBuffer(GL_ARRAY_BUFFER, plot->gridVBOy);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), NULL);
-	glEnableVertexAttribArray(0);
+	// gridlines have no vertex data, the grid program places them from
+	// uniforms, but core profile needs a VAO bound to draw
+	glGenVertexArrays(1, &plot->gridVAO);
 
-	// buffer setup for x grid labels
-	glGenVertexArrays(1, &plot->textVAOx);
-	glGenBuffers(1, &plot->textVBOx);
+	// buffer setup for text, one instance per character
+	glGenVertexArrays(1, &plot->textVAO);
+	glGenBuffers(1, &plot->textVBO);
 
-	glBindVertexArray(plot->textVAOx);
-	glBindBuffer(GL_ARRAY_BUFFER, plot->textVBOx);
+	glBindVertexArray(plot->textVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, plot->textVBO);
 
 	// xy start and offset
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), 0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(struct QDSPglyph), 0);
 	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
+	glVertexAttribPointer(1, 2, GL_SHORT, GL_FALSE, sizeof(struct QDSPglyph),
 	                      (void*)(2 * sizeof(float)));
 	glEnableVertexAttribArray(1);
-	// texture coord
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-	                      (void*)(4 * sizeof(float)));
+	// index into the atlas
+	glVertexAttribIPointer(2, 1, GL_UNSIGNED_SHORT, sizeof(struct QDSPglyph),
+	                       (void*)(2 * sizeof(float) + 2 * sizeof(short)));
 	glEnableVertexAttribArray(2);
-	
-	// buffer setup for y grid labels
-	glGenVertexArrays(1, &plot->textVAOy);
-	glGenBuffers(1, &plot->textVBOy);
 
-	glBindVertexArray(plot->textVAOy);
-	glBindBuffer(GL_ARRAY_BUFFER, plot->textVBOy);
+	glVertexAttribDivisor(0, 1);
+	glVertexAttribDivisor(1, 1);
+	glVertexAttribDivisor(2, 1);
 
-	// xy start and offset
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float), 0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-	                      (void*)(2 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	// texture coord
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(float),
-	                      (void*)(4 * sizeof(float)));
-	glEnableVertexAttribArray(2);
+	// label geometry is written in place, so it's allocated once
+	plot->gridGlyphs[0] = malloc(GRID_LABEL_CHARS * GRID_MAX_LABELS * sizeof(struct QDSPglyph));
+	plot->gridGlyphs[1] = malloc(GRID_LABEL_CHARS * GRID_MAX_LABELS * sizeof(struct QDSPglyph));
+	plot->hudGlyphs = malloc(HUD_CHARS * HUD_ROWS * sizeof(struct QDSPglyph));
 
 	int imgWidth, imgHeight;
-	// texture for drawing digits
-	glGenTextures(1, &plot->numTexture);
-	glBindTexture(GL_TEXTURE_2D, plot->numTexture);
+	// font atlas
+	glGenTextures(1, &plot->textTexture);
+	glBindTexture(GL_TEXTURE_2D, plot->textTexture);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	loadTexture("images/digits.png", &imgWidth, &imgHeight);	
+	loadTexture("images/ascii.png", &imgWidth, &imgHeight);
 
 	glUseProgram(plot->textProgram);
 	glUniform2f(glGetUniformLocation(plot->textProgram, "charDims"),
-	            imgWidth/15, imgHeight);
+	            imgWidth/ATLAS_CHARS, imgHeight);
+	glUniform1f(glGetUniformLocation(plot->textProgram, "atlasChars"), ATLAS_CHARS);
 	
 	// buffer setup for overlay
 	glGenVertexArrays(1, &plot->overlayVAO);
@@ -260,12 +838,130 @@ QDSPplot *qdspInit(const char *title) {
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	loadTexture("images/helpmessage.png", &imgWidth, &imgHeight);
-	
-	// dimensions
-	glUseProgram(plot->overlayProgram);
-	glUniform2f(glGetUniformLocation(plot->overlayProgram, "imgDims"),
-	            imgWidth, imgHeight);
+	loadTexture("images/helpmessage.png", &plot->helpDims[0], &plot->helpDims[1]);
+
+	// HUD background and labels, drawn by the overlay program
+	glGenTextures(1, &plot->hudTexture);
+	glBindTexture(GL_TEXTURE_2D, plot->hudTexture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	loadTexture("images/hud.png", &plot->hudDims[0], &plot->hudDims[1]);
+
+	// buffer setup for HUD frame-time graph, drawn by the grid program
+	plot->hudGraph = malloc(2 * QDSP_HUD_SAMPLES * sizeof(float));
+	glGenVertexArrays(1, &plot->hudGraphVAO);
+	glGenBuffers(1, &plot->hudGraphVBO);
+
+	glBindVertexArray(plot->hudGraphVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, plot->hudGraphVBO);
+	glBufferData(GL_ARRAY_BUFFER, 2 * QDSP_HUD_SAMPLES * sizeof(float),
+	             NULL, GL_DYNAMIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), NULL);
+	glEnableVertexAttribArray(0);
+
+	// buffer setup for the box zoom outline
+	glGenVertexArrays(1, &plot->boxVAO);
+	glGenBuffers(1, &plot->boxVBO);
+
+	glBindVertexArray(plot->boxVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, plot->boxVBO);
+	glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(float), NULL, GL_DYNAMIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), NULL);
+	glEnableVertexAttribArray(0);
+
+	// persistence: points accumulate in an offscreen buffer, which is only
+	// allocated once persistence is turned on
+	glGenVertexArrays(1, &plot->persistVAO);
+
+	// hover picking: point indices around the cursor go into a small integer
+	// target, and come back through a pixel buffer
+	glGenRenderbuffers(1, &plot->pickRBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, plot->pickRBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_R32UI, PICK_SIZE, PICK_SIZE);
+
+	glGenFramebuffers(1, &plot->pickFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, plot->pickFBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+	                          GL_RENDERBUFFER, plot->pickRBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	glGenBuffers(1, &plot->pickPBO);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, plot->pickPBO);
+	glBufferData(GL_PIXEL_PACK_BUFFER, PICK_SIZE * PICK_SIZE * sizeof(unsigned int),
+	             NULL, GL_STREAM_READ);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	// selection: transform feedback writes the selected indices, and the
+	// highlight is drawn from the same buffer
+	glGenVertexArrays(1, &plot->selectVAO);
+	glGenBuffers(1, &plot->selectVBO);
+	glGenQueries(1, &plot->selectQuery);
+
+	glBindVertexArray(plot->selectVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, plot->selectVBO);
+	glVertexAttribIPointer(0, 1, GL_INT, 0, NULL);
+	glEnableVertexAttribArray(0);
+
+	// box and lasso outlines, also read by the selection program through a
+	// texture buffer on unit 5
+	glGenVertexArrays(1, &plot->lassoVAO);
+	glGenBuffers(1, &plot->lassoVBO);
+	glGenTextures(1, &plot->lassoTexture);
+
+	glBindVertexArray(plot->lassoVAO);
+	glBindBuffer(GL_ARRAY_BUFFER, plot->lassoVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(plot->lasso), NULL, GL_DYNAMIC_DRAW);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), NULL);
+	glEnableVertexAttribArray(0);
+
+	glBindTexture(GL_TEXTURE_BUFFER, plot->lassoTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RG32F, plot->lassoVBO);
+
+	glUseProgram(plot->selectProgram);
+	glUniform1i(glGetUniformLocation(plot->selectProgram, "lasso"), 5);
+
+	glUseProgram(plot->highlightProgram);
+	glUniform1i(glGetUniformLocation(plot->highlightProgram, "xBuf"), 1);
+	glUniform1i(glGetUniformLocation(plot->highlightProgram, "yBuf"), 2);
+	glUniform1i(glGetUniformLocation(plot->highlightProgram, "useDouble"), 1);
+	glUniform1i(glGetUniformLocation(plot->highlightProgram, "defaultColor"), HIGHLIGHT_COLOR);
+	glUniform1f(glGetUniformLocation(plot->highlightProgram, "alpha"), 1.0f);
+
+	plot->hovered = -1;
+	plot->uploadStride = 1;
+
+	// filter values and masks, on texture units 6 and 7
+	glGenBuffers(2, plot->filterVBOs);
+	glGenTextures(2, plot->filterTextures);
+	GLenum filterFormats[] = {GL_R32F, GL_R32I};
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_TEXTURE_BUFFER, plot->filterVBOs[i]);
+		glBindTexture(GL_TEXTURE_BUFFER, plot->filterTextures[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, filterFormats[i], plot->filterVBOs[i]);
+	}
+
+	// every point is shown until a filter is set
+	int filtered[] = {plot->pointsProgram, plot->linesProgram, plot->trailsProgram,
+	                  plot->pickProgram, plot->selectProgram, plot->highlightProgram};
+	for (int i = 0; i < 6; i++) {
+		glUseProgram(filtered[i]);
+		glUniform1i(glGetUniformLocation(filtered[i], "valueBuf"), 6);
+		glUniform1i(glGetUniformLocation(filtered[i], "maskBuf"), 7);
+		glUniform1i(glGetUniformLocation(filtered[i], "stride"), 1);
+	}
+	for (int i = 0; i < 3; i++) {
+		plot->filterRange[i][0] = -INFINITY;
+		plot->filterRange[i][1] = INFINITY;
+	}
+	plot->filterClasses = ~0u;
+	setFilterUniforms(plot);
+
+	// timer queries for GPU time per pass
+	glGenQueries(6, &plot->gpuQueries[0][0]);
 
 	// transparency
 	glEnable(GL_BLEND);
@@ -273,14 +969,22 @@ QDSPplot *qdspInit(const char *title) {
 
 	glEnable(GL_PROGRAM_POINT_SIZE);
 
+	// panels only draw in their own part of the window
+	glEnable(GL_SCISSOR_TEST);
+
 	// default to 60 fps
 	qdspSetFramerate(plot, 60);
+
+	// gridlines follow the bounds until the user sets them
+	plot->xAutoGrid = 1;
+	plot->yAutoGrid = 1;
 	
 	// default bounds
 	qdspSetBounds(plot, -1.0f, 1.0f, -1.0f, 1.0f);
 
 	// default: single points, yellow, black background
 	qdspSetConnected(plot, 0);
+	qdspSetLineStyle(plot, 1.0, QDSP_JOIN_MITER);
 	qdspSetPointColor(plot, 0xffff33);
 	qdspSetBGColor(plot, 0x000000);
 
@@ -290,357 +994,3361 @@ QDSPplot *qdspInit(const char *title) {
 	
 	plot->paused = 0;
 	plot->frozen = 0;
+	plot->hidden = 0;
 	plot->overlay = 0;
 	plot->grid = 0;
+	plot->hud = 0;
 
-	plot->xAutoGrid = 1;
-	plot->yAutoGrid = 1;
-
-	resizeCallback(plot->window, 800, 600);
-	glfwSwapInterval(0);
 	// framerate stuff
 	clock_gettime(CLOCK_MONOTONIC, &plot->lastUpdate);
+	plot->lastRedraw = plot->lastUpdate;
+	plot->statsStart = plot->lastUpdate;
+	plot->lastReturn = plot->lastUpdate;
+	plot->budgetStart = plot->lastUpdate;
+	plot->budgetStride = 1;
+	plot->stats.pointStride = 1;
 
-	return plot;
+	plot->damage = DAMAGE_ALL;
+
+	return 1;
 }
 
 void qdspDelete(QDSPplot *plot) {
+	if (offThread(plot)) {
+		// this shuts down GLFW, so the render thread goes too, along with
+		// every threaded plot
+		pthread_mutex_lock(&startLock);
+		QDSPcommand cmd = {.kind = CMD_DELETE, .plot = plot};
+		if (postCommand(&cmd, &(QDSPwaiter){0})) {
+			pthread_join(renderThread, NULL);
+			renderRunning = 0;
+		}
+		pthread_mutex_unlock(&startLock);
+		return;
+	}
+
 	glfwTerminate();
+
+	// panels share the window, so they all go together
+	QDSPplot **panels = plot->panels;
+	int numPanels = plot->numPanels;
+	for (int i = 0; i < numPanels; i++)
+		freePanel(panels[i]);
+	free(panels);
+}
+
+static void freePanel(QDSPplot *plot) {
+	free(plot->gridGlyphs[0]);
+	free(plot->gridGlyphs[1]);
+	free(plot->hudGlyphs);
+	free(plot->glyphs);
+	for (int i = 0; i < QDSP_MAX_TEXT; i++)
+		free(plot->text[i]);
+	free(plot->hudGraph);
+	free(plot->curveTable);
+	free(plot->curveFirst);
+	free(plot->curveCount);
+	free(plot->segments);
+	free(plot->sortKeys);
+	free(plot->sortOrder);
+	if (plot->frameStaging != NULL)
+		munmap(plot->frameStaging, plot->frameStagingSize);
 	free(plot->title);
+	if (plot->streamMap != NULL)
+		munmap(plot->streamMap, plot->streamSize);
 	free(plot);
 }
 
 int qdspUpdate(QDSPplot *plot, double *x, double *y, int *color, int numPoints) {
-	glfwMakeContextCurrent(plot->window);
-	// we just got updated
-	clock_gettime(CLOCK_MONOTONIC, &plot->lastUpdate);
+	QDSParray xArr = {x, QDSP_FLOAT64, sizeof(double)};
+	QDSParray yArr = {y, QDSP_FLOAT64, sizeof(double)};
+	QDSParray colorArr = {color, QDSP_INT32, sizeof(int)};
+	return qdspUpdateArrays(plot, &xArr, &yArr, color ? &colorArr : NULL, numPoints);
+}
 
-	while (plot->paused) {
-		glfwWaitEvents();
-	}
-		
-	// someone closed the window
-	if (glfwWindowShouldClose(plot->window)) {
-		glfwDestroyWindow(plot->window);
-		return 0;
+// queues an update for the render thread, waiting until its data has been read
+// unless it's async
+static long long postUpdate(QDSPplot *plot, int kind, const QDSParray *x,
+                            const QDSParray *y, const QDSParray *color,
+                            size_t numPoints, int async) {
+	QDSPcommand cmd = {.kind = kind, .plot = plot, .numPoints = numPoints};
+	cmd.arrays[0] = *x;
+	cmd.arrays[1] = *y;
+	if ((cmd.hasColor = (color != NULL)))
+		cmd.arrays[2] = *color;
+
+	if (async) {
+		cmd.ticket = __atomic_add_fetch(&ticketsIssued, 1, __ATOMIC_RELAXED);
+		if (!postCommand(&cmd, NULL))
+			finishTicket(cmd.ticket);
+		return cmd.ticket;
 	}
+	return postCommand(&cmd, &(QDSPwaiter){0});
+}
 
-	// frozen: don't update data
-	if (plot->frozen) {
-		glfwPollEvents();
-		return 2;
+long long qdspUpdateArraysAsync(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                                const QDSParray *color, int numPoints) {
+	if (offThread(plot))
+		return postUpdate(plot, CMD_UPDATE, x, y, color, numPoints, 1);
+
+	// without a render thread, the data's been read as soon as we return
+	long long ticket = __atomic_add_fetch(&ticketsIssued, 1, __ATOMIC_RELAXED);
+	qdspUpdateArrays(plot, x, y, color, numPoints);
+	finishTicket(ticket);
+	return ticket;
+}
+
+int qdspWaitUpdate(QDSPplot *plot, long long ticket) {
+	pthread_mutex_lock(&renderLock);
+	while (ticketsDone < ticket)
+		pthread_cond_wait(&renderDone, &renderLock);
+	pthread_mutex_unlock(&renderLock);
+
+	return !__atomic_load_n(&plot->closed, __ATOMIC_RELAXED);
+}
+
+int qdspUpdateFilter(QDSPplot *plot, const QDSParray *values, const QDSParray *mask,
+                     int numPoints) {
+	if (numPoints < 0)
+		numPoints = 0;
+
+	if (offThread(plot)) {
+		QDSPcommand cmd = {.kind = CMD_UPDATE_FILTER, .plot = plot, .numPoints = numPoints};
+		if (values != NULL)
+			cmd.arrays[0] = *values;
+		if (mask != NULL)
+			cmd.arrays[1] = *mask;
+		return postCommand(&cmd, &(QDSPwaiter){0});
 	}
-	
-	// copy all our vertex stuff
-	glUseProgram(plot->pointsProgram);
 
-	glBindBuffer(GL_ARRAY_BUFFER, plot->pointsVBOx);
-	glBufferData(GL_ARRAY_BUFFER, numPoints * sizeof(double), x, GL_STREAM_DRAW);
+	if (plot->closed)
+		return 0;
 
-	glBindBuffer(GL_ARRAY_BUFFER, plot->pointsVBOy);
-	glBufferData(GL_ARRAY_BUFFER, numPoints * sizeof(double), y, GL_STREAM_DRAW);
+	QDSParray valueArr = {0}, maskArr = {0};
+	if (values != NULL && values->data != NULL)
+		valueArr = *values;
+	else
+		values = NULL;
+	if (mask != NULL && mask->data != NULL)
+		maskArr = *mask;
+	else
+		mask = NULL;
 
-	glBindBuffer(GL_ARRAY_BUFFER, plot->pointsVBOrgb);
-	glBufferData(GL_ARRAY_BUFFER, numPoints * sizeof(int), color, GL_STREAM_DRAW);
+	if ((values != NULL && !checkArray(&valueArr, 0)) || (mask != NULL && !checkArray(&maskArr, 1))) {
+		fprintf(stderr, "Unsupported array type\n");
+		return 0;
+	}
 
-	// should we use the default color?
-	glUniform1i(glGetUniformLocation(plot->pointsProgram, "useCustom"), color != NULL);
+	glfwMakeContextCurrent(plot->window);
 
-	plot->numPoints = numPoints;
-	
-	// drawing:
-	qdspRedraw(plot);
-	
-	glfwPollEvents();
+	// values are floats on the GPU, and masks ints; anything else is
+	// gathered first
+	int *scratch = NULL;
+	if ((values != NULL && !isPacked(&valueArr, QDSP_FLOAT32)) ||
+	    (mask != NULL && !isPacked(&maskArr, QDSP_INT32))) {
+		scratch = malloc(numPoints * sizeof(int));
+		if (scratch == NULL && numPoints > 0) {
+			fprintf(stderr, "Couldn't allocate filter data\n");
+			return 0;
+		}
+	}
 
-	return 1;
-}
+	if (values != NULL) {
+		const void *src = valueArr.data;
+		if (!isPacked(&valueArr, QDSP_FLOAT32)) {
+			float *dst = (float*)scratch;
+			const char *p = valueArr.data;
+			if (valueArr.type == QDSP_FLOAT64) {
+				for (int i = 0; i < numPoints; i++)
+					dst[i] = *(const double*)(p + i * valueArr.stride);
+			} else {
+				for (int i = 0; i < numPoints; i++)
+					dst[i] = *(const float*)(p + i * valueArr.stride);
+			}
+			src = dst;
+		}
+		glBindBuffer(GL_TEXTURE_BUFFER, plot->filterVBOs[0]);
+		glBufferData(GL_TEXTURE_BUFFER, numPoints * sizeof(float), src, GL_DYNAMIC_DRAW);
+	}
 
-int qdspUpdateIfReady(QDSPplot *plot, double *x, double *y, int *color, int numPoints) {
-	// get ms since last full update
-	struct timespec lastTime = plot->lastUpdate;
-	struct timespec newTime;
-	clock_gettime(CLOCK_MONOTONIC, &newTime);
-	double msDiff = ((double)newTime.tv_sec*1.0e3 + newTime.tv_nsec*1.0e-6) - 
-		((double)lastTime.tv_sec*1.0e3 + lastTime.tv_nsec*1.0e-6);
-	
-	if (msDiff >= plot->frameInterval)
-		return qdspUpdate(plot, x, y, color, numPoints);
-	else
-		return 2;
-}
+	if (mask != NULL) {
+		const int *src = isPacked(&maskArr, QDSP_INT32) ? maskArr.data
+		                 : chunkColors(&maskArr, 0, numPoints, scratch);
+		glBindBuffer(GL_TEXTURE_BUFFER, plot->filterVBOs[1]);
+		glBufferData(GL_TEXTURE_BUFFER, numPoints * sizeof(int), src, GL_DYNAMIC_DRAW);
+	}
+	free(scratch);
 
-int qdspUpdateWait(QDSPplot *plot, double *x, double *y, int *color, int numPoints) {
-	// get ms since last full update
-	struct timespec lastTime = plot->lastUpdate;
-	struct timespec newTime;
-	clock_gettime(CLOCK_MONOTONIC, &newTime);
-	double msDiff = ((double)newTime.tv_sec*1.0e3 + newTime.tv_nsec*1.0e-6) -
-		((double)lastTime.tv_sec*1.0e3 + lastTime.tv_nsec*1.0e-6);
+	plot->hasValues = (values != NULL);
+	plot->hasMask = (mask != NULL);
+	plot->numFiltered = (values != NULL || mask != NULL) ? numPoints : 0;
+	setFilterUniforms(plot);
+	plot->damage |= DAMAGE_DATA;
 
-	if (msDiff < plot->frameInterval)
-		usleep((plot->frameInterval - msDiff) * 1000);
+	if (plot->hoverCallback)
+		plot->pickPending = 1;
 
-	return qdspUpdate(plot, x, y, color, numPoints);
+	return 1;
 }
 
-void qdspRedraw(QDSPplot *plot) {
-	glfwMakeContextCurrent(plot->window);
-	
-	glClear(GL_COLOR_BUFFER_BIT);
+int qdspUpdateFile(QDSPplot *plot, const char *path, const QDSPcolumn *x,
+                   const QDSPcolumn *y, const QDSPcolumn *color, long long numPoints) {
+	if (offThread(plot)) {
+		QDSPcommand cmd = {.kind = CMD_UPDATE_FILE, .plot = plot, .text = (char*)path,
+		                   .columns = {x, y, color}, .numRows = numPoints};
+		return postCommand(&cmd, &(QDSPwaiter){0});
+	}
 
-	// grid
-	if (plot->grid) {
-		glUseProgram(plot->gridProgram);
+	int gate = gateUpdate(plot);
+	if (gate >= 0)
+		return gate;
 
-		glUniform1i(glGetUniformLocation(plot->gridProgram, "useY"), 0);
-		glBindVertexArray(plot->gridVAOx);
-		glDrawArrays(GL_LINES, 0, 4 * plot->numGridX);
+	struct timespec enter;
+	clock_gettime(CLOCK_MONOTONIC, &enter);
 
-		glUniform1i(glGetUniformLocation(plot->gridProgram, "useY"), 1);
-		glBindVertexArray(plot->gridVAOy);
-		glDrawArrays(GL_LINES, 0, 4 * plot->numGridY);
+	int fd = open(path, O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		fprintf(stderr, "Couldn't open %s\n", path);
+		if (fd >= 0)
+			close(fd);
+		return 0;
 	}
-	
-	// points
+
+	// columns are checked like arrays, and have to end inside the file
+	const QDSPcolumn *columns[] = {x, y, color};
+	QDSParray arrays[3] = {{0}};
+	int numColumns = color ? 3 : 2;
+	for (int i = 0; i < numColumns; i++) {
+		arrays[i].type = columns[i]->type;
+		arrays[i].stride = columns[i]->stride;
+		if (!checkArray(&arrays[i], i == 2) || arrays[i].stride < 0) {
+			fprintf(stderr, "Unsupported array type\n");
+			close(fd);
+			return 0;
+		}
+
+		long long offset = columns[i]->offset;
+		long long size = (arrays[i].type == QDSP_FLOAT64) ? sizeof(double) : 4;
+		if (numPoints > 0 && (offset < 0 || offset + size > st.st_size ||
+		                      numPoints - 1 > (st.st_size - offset - size) / arrays[i].stride)) {
+			fprintf(stderr, "Column %d runs past the end of %s\n", i, path);
+			close(fd);
+			return 0;
+		}
+	}
+
+	// the mapping only costs address space; pages are read as they're streamed
+	void *map = NULL;
+	if (numPoints > 0) {
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			fprintf(stderr, "Couldn't map %s\n", path);
+			close(fd);
+			return 0;
+		}
+		madvise(map, st.st_size, MADV_SEQUENTIAL);
+	}
+	close(fd);
+
+	// updated twice since the window was drawn, so other panels aren't
+	// keeping up; finish the frame without them
+	if (plot->panelUpdated)
+		qdspRedraw(plot);
+
+	endStream(plot);
+	if (plot->streamFBO == 0)
+		initStream(plot);
+
+	plot->streaming = 1;
+	plot->streamMap = map;
+	plot->streamSize = st.st_size;
+	for (int i = 0; i < numColumns; i++) {
+		arrays[i].data = (const char*)map + columns[i]->offset;
+		plot->streamColumns[i] = arrays[i];
+	}
+	plot->streamHasColor = (color != NULL);
+	plot->streamPoints = numPoints;
+
+	// nothing from earlier updates is drawn, picked, or selected
+	plot->numPoints = 0;
+	plot->numSelected = 0;
+	plot->trailFilled = 0;
+	plot->curveMode = 0;
+	plot->damage |= DAMAGE_DATA;
+
+	if (plot->hoverCallback)
+		plot->pickPending = 1;
+
+	// the path and columns have been read, so a threaded caller can go
+	if (plot->threaded)
+		finishCommand(1);
+
+	plot->panelUpdated = 1;
+	if (allUpdated(plot))
+		qdspRedraw(plot);
+
+	glfwPollEvents();
+	servicePicks(plot);
+
+	governOverhead(plot, &enter);
+
+	return 1;
+}
+
+int qdspUpdateArrays(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                     const QDSParray *color, int numPoints) {
+	return qdspUpdateArraysLarge(plot, x, y, color, numPoints > 0 ? numPoints : 0);
+}
+
+int qdspUpdateArraysLarge(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                          const QDSParray *color, size_t numPoints) {
+	if (offThread(plot))
+		return postUpdate(plot, CMD_UPDATE, x, y, color, numPoints, 0);
+
+	QDSParray xArr = *x, yArr = *y, colorArr;
+	if (color != NULL && color->data != NULL)
+		colorArr = *color;
+	else
+		color = NULL;
+
+	if (!checkArray(&xArr, 0) || !checkArray(&yArr, 0)
+	    || (color != NULL && !checkArray(&colorArr, 1))) {
+		fprintf(stderr, "Unsupported array type\n");
+		return 0;
+	}
+
+	return updatePlot(plot, &xArr, &yArr, color ? &colorArr : NULL, numPoints,
+	                  NULL, NULL, NULL, 0);
+}
+
+int qdspUpdateArraysIfReady(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                            const QDSParray *color, int numPoints) {
+	if (offThread(plot))
+		return postUpdate(plot, CMD_UPDATE_IF_READY, x, y, color, numPoints, 0);
+
+	if (msSinceUpdate(plot) >= plot->frameInterval)
+		return qdspUpdateArrays(plot, x, y, color, numPoints);
+	else
+		return 2;
+}
+
+int qdspUpdateArraysWait(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                         const QDSParray *color, int numPoints) {
+	if (offThread(plot))
+		return postUpdate(plot, CMD_UPDATE_WAIT, x, y, color, numPoints, 0);
+
+	double ms = msSinceUpdate(plot);
+	if (ms < plot->frameInterval)
+		usleep((plot->frameInterval - ms) * 1000);
+
+	return qdspUpdateArrays(plot, x, y, color, numPoints);
+}
+
+int qdspUpdateCurves(QDSPplot *plot, double *x, double *y, int numPoints,
+                     int *starts, int *counts, int *colors, int numCurves) {
+	if (numPoints < 0)
+		numPoints = 0;
+
+	if (offThread(plot)) {
+		QDSPcommand cmd = {.kind = CMD_UPDATE_CURVES, .plot = plot, .numPoints = numPoints,
+		                   .curves = {starts, counts, colors}, .numCurves = numCurves};
+		cmd.arrays[0].data = x;
+		cmd.arrays[1].data = y;
+		return postCommand(&cmd, &(QDSPwaiter){0});
+	}
+
+	// the shader finds each segment's curve by binary search, so curves have
+	// to be in order and can't overlap
+	int end = 0;
+	for (int i = 0; i < numCurves; i++) {
+		if (counts[i] == 0)
+			continue;
+		if (counts[i] < 0 || starts[i] < end || counts[i] > numPoints - starts[i]) {
+			fprintf(stderr, "Curve %d overlaps another or is out of bounds\n", i);
+			return 0;
+		}
+		end = starts[i] + counts[i];
+	}
+
+	QDSParray xArr = {x, QDSP_FLOAT64, sizeof(double)};
+	QDSParray yArr = {y, QDSP_FLOAT64, sizeof(double)};
+	return updatePlot(plot, &xArr, &yArr, NULL, numPoints, starts, counts, colors, numCurves);
+}
+
+// shared by all the update functions; array strides are filled in, and
+// starts is NULL for a single curve. x and y are NULL for a frame already
+// written into the point buffers, with color only saying whether it has colors
+static int updatePlot(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                      const QDSParray *color, size_t numPoints,
+                      int *starts, int *counts, int *curveColors, int numCurves) {
+	int gate = gateUpdate(plot);
+	if (gate >= 0)
+		return gate;
+
+	// arrays replace a file
+	endStream(plot);
+
+	struct timespec enter;
+	clock_gettime(CLOCK_MONOTONIC, &enter);
+
+	// thinned out for the overhead budget, by stepping over points (frames
+	// written in place are already on the GPU whole)
+	QDSParray thinX, thinY, thinColor;
+	int lastStride = plot->uploadStride;
+	plot->uploadStride = 1;
+	if (plot->budgetStride > 1 && starts == NULL && !plot->connected && x != NULL) {
+		int stride = plot->budgetStride;
+		plot->uploadStride = stride;
+		thinX = *x;
+		thinX.stride *= stride;
+		x = &thinX;
+		thinY = *y;
+		thinY.stride *= stride;
+		y = &thinY;
+		if (color != NULL) {
+			thinColor = *color;
+			thinColor.stride *= stride;
+			color = &thinColor;
+		}
+		numPoints = (numPoints + stride - 1) / stride;
+	}
+
+	// updated twice since the window was drawn, so other panels aren't
+	// keeping up; finish the frame without them
+	if (plot->panelUpdated)
+		qdspRedraw(plot);
+	
+	// line strips carry on from one segment to the next
+	plot->segmentOverlap = (plot->connected || starts != NULL);
+	if (!splitPoints(plot, numPoints))
+		return 0;
+
+	// copy all our vertex stuff
 	glUseProgram(plot->pointsProgram);
-	glBindVertexArray(plot->pointsVAO);
-	glDrawArrays(plot->connected ? GL_LINE_STRIP : GL_POINTS,
-	             0, plot->numPoints);
 
-	// labels
+	// packed doubles can go straight to the driver
+	int packed = x != NULL && isPacked(x, QDSP_FLOAT64) && isPacked(y, QDSP_FLOAT64)
+		&& (color == NULL || isPacked(color, QDSP_INT32));
+
+	// points can only be reordered if nothing goes by their index: lines,
+	// trails, picking, filter data, and highlighted selections all do
+	const unsigned int *order = NULL;
+	int selecting = plot->numSelected > 0 || plot->selectPending || plot->selectFence != NULL;
+	if (plot->spatialSort && x != NULL && starts == NULL && !plot->connected && plot->trailLength == 0
+	    && plot->hoverCallback == NULL && plot->selectCallback == NULL && !selecting
+	    && plot->numFiltered == 0 && numPoints >= SORT_MIN_POINTS && numPoints <= UINT_MAX)
+		order = sortPoints(plot, x, y, numPoints);
+	else {
+		if (plot->sortValid)
+			unsortSelection(plot, lastStride);
+		plot->sortValid = 0;
+		if (!plot->spatialSort) {
+			free(plot->sortKeys);
+			free(plot->sortOrder);
+			plot->sortKeys = NULL;
+			plot->sortOrder = NULL;
+			plot->sortCapacity = 0;
+		}
+	}
+
+	if (x == NULL) {
+		// written in place by qdspFrameSlice
+	} else if ((plot->autoBounds || plot->highPrecision || !packed || order) && numPoints > 0) {
+		// converting, gathering, reordering, or finding the data range is
+		// done during the copy
+		uploadPoints(plot, x, y, color, numPoints, order);
+	} else {
+		for (int k = 0; k < plot->numSegments; k++) {
+			struct QDSPsegment *seg = &plot->segments[k];
+			size_t first = segmentBase(plot, k);
+			size_t count = segmentSize(plot, k);
+
+			glBindBuffer(GL_ARRAY_BUFFER, seg->vbos[0]);
+			glBufferData(GL_ARRAY_BUFFER, count * sizeof(double),
+			             (const double*)x->data + first, GL_STREAM_DRAW);
+
+			glBindBuffer(GL_ARRAY_BUFFER, seg->vbos[1]);
+			glBufferData(GL_ARRAY_BUFFER, count * sizeof(double),
+			             (const double*)y->data + first, GL_STREAM_DRAW);
+
+			glBindBuffer(GL_ARRAY_BUFFER, seg->vbos[2]);
+			glBufferData(GL_ARRAY_BUFFER, count * sizeof(int),
+			             color ? (const int*)color->data + first : NULL, GL_STREAM_DRAW);
+		}
+	}
+
+	setPointUniforms(plot, color != NULL);
+
+	plot->damage |= DAMAGE_DATA;
+
+	// a different point may be under the cursor now
+	if (plot->hoverCallback)
+		plot->pickPending = 1;
+
+	if (plot->trailLength > 0)
+		pushTrail(plot);
+
+	size_t coordSize = plot->highPrecision ? sizeof(float) : sizeof(double);
+	long long bytes = numPoints * (2 * coordSize + (color ? sizeof(int) : 0));
+
+	plot->curveMode = (starts != NULL);
+	if (plot->curveMode)
+		bytes += uploadCurves(plot, starts, counts, curveColors, numCurves);
+	plot->statsPoints += numPoints;
+	plot->statsBytes += bytes;
+	plot->stats.pointsUploaded += numPoints;
+	plot->stats.bytesUploaded += bytes;
+
+	// the caller's arrays aren't needed any more, so a threaded caller can go
+	if (plot->threaded)
+		finishCommand(1);
+	
+	// drawing: with several panels, once all of them have new data
+	plot->panelUpdated = 1;
+	if (allUpdated(plot))
+		qdspRedraw(plot);
+	
+	glfwPollEvents();
+	servicePicks(plot);
+
+	governOverhead(plot, &enter);
+
+	return 1;
+}
+
+int qdspUpdateIfReady(QDSPplot *plot, double *x, double *y, int *color, int numPoints) {
+	QDSParray xArr = {x, QDSP_FLOAT64, sizeof(double)};
+	QDSParray yArr = {y, QDSP_FLOAT64, sizeof(double)};
+	QDSParray colorArr = {color, QDSP_INT32, sizeof(int)};
+	return qdspUpdateArraysIfReady(plot, &xArr, &yArr, color ? &colorArr : NULL, numPoints);
+}
+
+int qdspUpdateWait(QDSPplot *plot, double *x, double *y, int *color, int numPoints) {
+	QDSParray xArr = {x, QDSP_FLOAT64, sizeof(double)};
+	QDSParray yArr = {y, QDSP_FLOAT64, sizeof(double)};
+	QDSParray colorArr = {color, QDSP_INT32, sizeof(int)};
+	return qdspUpdateArraysWait(plot, &xArr, &yArr, color ? &colorArr : NULL, numPoints);
+}
+
+int qdspBeginFrame(QDSPplot *plot, size_t numPoints, int hasColor) {
+	if (offThread(plot)) {
+		QDSPcommand cmd = {.kind = CMD_BEGIN_FRAME, .plot = plot, .numPoints = numPoints,
+		                   .i = {hasColor}};
+		return postCommand(&cmd, &(QDSPwaiter){0});
+	}
+
+	if (plot->closed || plot->frameOpen)
+		return 0;
+
+	glfwMakeContextCurrent(plot->window);
+	plot->framePoints = numPoints;
+	plot->frameHasColor = hasColor;
+	plot->frameMapped = 0;
+
+	// straight into the point buffers if they take doubles as they are; the
+	// render thread of a threaded plot could draw from them while they're
+	// mapped, so those always stage. So does a frame that qdspEndFrame
+	// wouldn't upload, since the buffers still hold what's on screen
+	int held = plot->paused || plot->frozen || plot->hidden
+		|| (plot->overheadBudget > 0 && msSinceUpdate(plot) < plot->budgetInterval);
+	if (!plot->autoBounds && !plot->highPrecision && !plot->spatialSort && !plot->threaded
+	    && !held && numPoints > 0 && numPoints <= plot->segmentPoints) {
+		if (plot->sortValid)
+			unsortSelection(plot, plot->uploadStride);
+		plot->sortValid = 0;
+
+		plot->segmentOverlap = plot->connected;
+		if (!splitPoints(plot, numPoints))
+			return 0;
+
+		// the buffers are about to be replaced, so whatever draws from them
+		// next has to read them as this frame
+		plot->uploadStride = 1;
+		plot->curveMode = 0;
+		setPointUniforms(plot, hasColor);
+
+		void *dst[3] = {NULL};
+		size_t sizes[] = {numPoints * sizeof(double), numPoints * sizeof(double),
+		                  numPoints * sizeof(int)};
+		int mapped = 1;
+		for (int i = 0; i < 3; i++) {
+			glBindBuffer(GL_ARRAY_BUFFER, plot->segments[0].vbos[i]);
+			glBufferData(GL_ARRAY_BUFFER, sizes[i], NULL, GL_STREAM_DRAW);
+			if (i < 2 || hasColor) {
+				dst[i] = glMapBufferRange(GL_ARRAY_BUFFER, 0, sizes[i],
+				                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+				mapped = mapped && dst[i] != NULL;
+			}
+		}
+
+		if (mapped) {
+			plot->frameX = dst[0];
+			plot->frameY = dst[1];
+			plot->frameColor = dst[2];
+			plot->frameMapped = 1;
+			plot->frameOpen = 1;
+			return 1;
+		}
+
+		// couldn't map them all, so stage instead
+		for (int i = 0; i < 3; i++) {
+			if (dst[i] != NULL) {
+				glBindBuffer(GL_ARRAY_BUFFER, plot->segments[0].vbos[i]);
+				glUnmapBuffer(GL_ARRAY_BUFFER);
+			}
+		}
+	}
+
+	// staging memory is mapped fresh from the OS and never written here, so
+	// its pages are placed when the application's threads first touch them
+	size_t size = numPoints * (2 * sizeof(double) + sizeof(int));
+	if (size > plot->frameStagingSize) {
+		if (plot->frameStaging != NULL)
+			munmap(plot->frameStaging, plot->frameStagingSize);
+		plot->frameStaging = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		plot->frameStagingSize = size;
+		if (plot->frameStaging == MAP_FAILED) {
+			fprintf(stderr, "Couldn't allocate memory for a frame\n");
+			plot->frameStaging = NULL;
+			plot->frameStagingSize = 0;
+			return 0;
+		}
+	}
+
+	plot->frameX = plot->frameStaging;
+	plot->frameY = plot->frameX + numPoints;
+	plot->frameColor = hasColor ? (int*)(plot->frameY + numPoints) : NULL;
+	plot->frameOpen = 1;
+	return 1;
+}
+
+QDSPslice qdspFrameSlice(QDSPplot *plot, size_t offset, size_t count) {
+	QDSPslice slice = {NULL, NULL, NULL};
+	if (!plot->frameOpen || offset > plot->framePoints || count > plot->framePoints - offset)
+		return slice;
+
+	slice.x = plot->frameX + offset;
+	slice.y = plot->frameY + offset;
+	if (plot->frameColor != NULL)
+		slice.color = plot->frameColor + offset;
+	return slice;
+}
+
+int qdspEndFrame(QDSPplot *plot) {
+	if (offThread(plot))
+		return postCommand(&(QDSPcommand){.kind = CMD_END_FRAME, .plot = plot}, &(QDSPwaiter){0});
+
+	if (!plot->frameOpen)
+		return 0;
+	plot->frameOpen = 0;
+
+	glfwMakeContextCurrent(plot->window);
+	size_t numPoints = plot->framePoints;
+	QDSParray colorArr = {plot->frameColor, QDSP_INT32, sizeof(int)};
+	const QDSParray *color = plot->frameHasColor ? &colorArr : NULL;
+
+	if (plot->frameMapped) {
+		// if unmapping fails the buffers are garbage until the next update
+		int unmapped = 1;
+		for (int i = 0; i < (color ? 3 : 2); i++) {
+			glBindBuffer(GL_ARRAY_BUFFER, plot->segments[0].vbos[i]);
+			unmapped = glUnmapBuffer(GL_ARRAY_BUFFER) && unmapped;
+		}
+		if (!unmapped)
+			return 0;
+		return updatePlot(plot, NULL, NULL, color, numPoints, NULL, NULL, NULL, 0);
+	}
+
+	QDSParray xArr = {plot->frameX, QDSP_FLOAT64, sizeof(double)};
+	QDSParray yArr = {plot->frameY, QDSP_FLOAT64, sizeof(double)};
+	return updatePlot(plot, &xArr, &yArr, color, numPoints, NULL, NULL, NULL, 0);
+}
+
+int qdspPoll(QDSPplot *plot) {
+	// the render thread keeps handling events by itself
+	if (offThread(plot))
+		return !__atomic_load_n(&plot->closed, __ATOMIC_RELAXED);
+
+	if (plot->closed)
+		return 0;
+
+	glfwMakeContextCurrent(plot->window);
+	glfwPollEvents();
+
+	if (windowClosed(plot))
+		return 0;
+
+	servicePicks(plot);
+
+	// panning and zooming redraws from the buffers already on the GPU
+	if (windowDirty(plot))
+		qdspRedraw(plot);
+
+	return 1;
+}
+
+// whether any panel in the window is writing a frame into its point buffers
+static int frameMapped(QDSPplot *plot) {
+	for (int i = 0; i < plot->numPanels; i++) {
+		if (plot->panels[i]->frameOpen && plot->panels[i]->frameMapped)
+			return 1;
+	}
+	return 0;
+}
+
+// destroys the window if someone closed it, for every panel in it
+static int windowClosed(QDSPplot *plot) {
+	if (!glfwWindowShouldClose(plot->window))
+		return 0;
+
+	glfwDestroyWindow(plot->window);
+	for (int i = 0; i < plot->numPanels; i++)
+		plot->panels[i]->closed = 1;
+	return 1;
+}
+
+// what every update goes through before it touches the data: -1 to go ahead,
+// or what the update returns without doing anything (0 if the window's
+// closed, 2 if it's frozen or too soon for the overhead budget, 1 if it's
+// minimized)
+static int gateUpdate(QDSPplot *plot) {
+	// another panel saw the window close
+	if (plot->closed)
+		return 0;
+
+	if (plot->frameOpen) {
+		fprintf(stderr, "Can't update a plot while a frame is open\n");
+		return 0;
+	}
+
+	// too soon for the overhead budget
+	if (plot->overheadBudget > 0 && msSinceUpdate(plot) < plot->budgetInterval)
+		return 2;
+
+	glfwMakeContextCurrent(plot->window);
+	// we just got updated
+	clock_gettime(CLOCK_MONOTONIC, &plot->lastUpdate);
+
+	while (plot->paused) {
+		glfwWaitEvents();
+		servicePicks(plot);
+		// panning and zooming redraws from the buffers already on the GPU
+		if (windowDirty(plot))
+			qdspRedraw(plot);
+	}
+		
+	// someone closed the window
+	if (windowClosed(plot))
+		return 0;
+
+	// frozen: don't update data
+	if (plot->frozen) {
+		glfwPollEvents();
+		servicePicks(plot);
+		if (windowDirty(plot))
+			qdspRedraw(plot);
+		return 2;
+	}
+
+	// minimized: nobody would see the data, so it isn't even uploaded; the
+	// next update after the window comes back brings the latest
+	if (plot->hidden) {
+		glfwPollEvents();
+		return 1;
+	}
+
+	return -1;
+}
+
+// tells the shaders whether points have their own colors, and how far apart
+// the uploaded points are in the application's arrays
+static void setPointUniforms(QDSPplot *plot, int useCustom) {
+	int programs[] = {plot->pointsProgram, plot->linesProgram, plot->trailsProgram};
+	for (int i = 0; i < 3; i++) {
+		glUseProgram(programs[i]);
+		glUniform1i(glGetUniformLocation(programs[i], "useCustom"), useCustom);
+	}
+
+	// filter data is indexed like the application's arrays; lines are
+	// never thinned
+	int strided[] = {plot->pointsProgram, plot->trailsProgram, plot->pickProgram,
+	                 plot->selectProgram, plot->highlightProgram};
+	for (int i = 0; i < 5; i++) {
+		glUseProgram(strided[i]);
+		glUniform1i(glGetUniformLocation(strided[i], "stride"), plot->uploadStride);
+	}
+}
+
+// ms since last full update
+static double msSinceUpdate(QDSPplot *plot) {
+	struct timespec newTime;
+	clock_gettime(CLOCK_MONOTONIC, &newTime);
+	return msDiff(&plot->lastUpdate, &newTime);
+}
+
+// times an update against the time since the last one, and every so often
+// picks the update interval and point stride that keep to the budget
+static void governOverhead(QDSPplot *plot, const struct timespec *enter) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	plot->insideMs += msDiff(enter, &now);
+	plot->outsideMs += msDiff(&plot->lastReturn, enter);
+	plot->budgetUpdates++;
+	plot->lastReturn = now;
+
+	if (msDiff(&plot->budgetStart, &now) < STATS_INTERVAL)
+		return;
+
+	double updateMs = plot->insideMs / plot->budgetUpdates;
+	plot->stats.overhead = plot->insideMs / (plot->insideMs + plot->outsideMs);
+
+	plot->budgetStart = now;
+	plot->insideMs = 0;
+	plot->outsideMs = 0;
+	plot->budgetUpdates = 0;
+
+	if (plot->overheadBudget <= 0)
+		return;
+
+	// one update every this many ms is within budget
+	double interval = updateMs / plot->overheadBudget;
+
+	// past the slowest framerate we'd show, send fewer points instead; come
+	// back once twice the points would comfortably fit again
+	int stride = plot->budgetStride;
+	double slowest = 1000.0 / BUDGET_MIN_FPS;
+	if (plot->connected || plot->curveMode) {
+		// lines would change shape
+		stride = 1;
+	} else if (interval > slowest && stride < BUDGET_MAX_STRIDE) {
+		// updates take about half as long from now on
+		stride *= 2;
+		interval /= 2;
+	} else if (stride > 1 && 2 * interval < slowest / 2) {
+		stride /= 2;
+		interval *= 2;
+	}
+
+	// the trailed points are different ones now
+	if (stride != plot->budgetStride)
+		plot->trailFilled = 0;
+
+	plot->budgetInterval = interval;
+	plot->budgetStride = stride;
+	plot->stats.budgetFps = 1000.0 / fmax(fmax(interval, plot->frameInterval), 1.0e-3);
+	plot->stats.pointStride = stride;
+}
+
+// validates an array's type and fills in its stride if it's packed
+static int checkArray(QDSParray *arr, int color) {
+	size_t size;
+	if (color && arr->type == QDSP_INT32)
+		size = sizeof(int);
+	else if (!color && arr->type == QDSP_FLOAT64)
+		size = sizeof(double);
+	else if (!color && arr->type == QDSP_FLOAT32)
+		size = sizeof(float);
+	else
+		return 0;
+
+	if (arr->stride == 0)
+		arr->stride = size;
+	return 1;
+}
+
+static int isPacked(const QDSParray *arr, int type) {
+	size_t size = (type == QDSP_FLOAT64) ? sizeof(double) : 4;
+	return arr->type == type && arr->stride == (ptrdiff_t)size;
+}
+
+// whether a call has to be passed on to the render thread
+static int offThread(QDSPplot *plot) {
+	return plot->threaded && !pthread_equal(pthread_self(), renderThread);
+}
+
+// queues a copy of a command, and waits for it to finish if there's a waiter
+static int postCommand(const QDSPcommand *cmd, QDSPwaiter *waiter) {
+	QDSPcommand *copy = malloc(sizeof(QDSPcommand));
+	if (copy == NULL) {
+		fprintf(stderr, "Couldn't queue a call for the render thread\n");
+		if (cmd->kind == CMD_SET_TEXT)
+			free(cmd->text);
+		return 0;
+	}
+	*copy = *cmd;
+	copy->waiter = waiter;
+
+	if (waiter != NULL) {
+		waiter->done = 0;
+		waiter->result = 0;
+		waiter->value = NULL;
+	}
+
+	// the render thread is gone, so the call fails
+	if (!pushCommand(copy)) {
+		if (cmd->kind == CMD_SET_TEXT)
+			free(cmd->text);
+		free(copy);
+		return 0;
+	}
+
+	if (waiter == NULL)
+		return 1;
+
+	pthread_mutex_lock(&renderLock);
+	while (!waiter->done)
+		pthread_cond_wait(&renderDone, &renderLock);
+	pthread_mutex_unlock(&renderLock);
+	return waiter->result;
+}
+
+// returns 0 if the render thread has stopped taking commands
+static int pushCommand(QDSPcommand *cmd) {
+	__atomic_add_fetch(&pushers, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&queueClosed, __ATOMIC_SEQ_CST)) {
+		__atomic_sub_fetch(&pushers, 1, __ATOMIC_RELEASE);
+		return 0;
+	}
+
+	cmd->next = NULL;
+	QDSPcommand *prev = __atomic_exchange_n(&queueTail, cmd, __ATOMIC_ACQ_REL);
+	__atomic_store_n(&prev->next, cmd, __ATOMIC_RELEASE);
+
+	// wakes the render thread if it's waiting for events; without GLFW, it
+	// finds the command within RENDER_POLL anyway
+	if (__atomic_load_n(&glfwLive, __ATOMIC_SEQ_CST))
+		glfwPostEmptyEvent();
+
+	__atomic_sub_fetch(&pushers, 1, __ATOMIC_RELEASE);
+	return 1;
+}
+
+// render thread only: stops producers from posting empty events, and from
+// queueing anything if closeQueue is set, once the ones already at it finish
+static void stopPushers(int closeQueue) {
+	__atomic_store_n(&glfwLive, 0, __ATOMIC_SEQ_CST);
+	if (closeQueue)
+		__atomic_store_n(&queueClosed, 1, __ATOMIC_SEQ_CST);
+	while (__atomic_load_n(&pushers, __ATOMIC_SEQ_CST) != 0)
+		sched_yield();
+}
+
+// the command taken stays in the queue as its head until the next one is
+// taken, so that's when it's freed
+static QDSPcommand *popCommand(void) {
+	QDSPcommand *head = queueHead;
+	QDSPcommand *next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+	if (next == NULL)
+		return NULL;
+
+	queueHead = next;
+	if (head != &renderStub)
+		free(head);
+	return next;
+}
+
+// runs a command on the render thread, returns 0 once the thread should stop
+static int runCommand(QDSPcommand *cmd) {
+	QDSPplot *plot = cmd->plot;
+	QDSPplot **panels;
+	int result = 0;
+	renderCommand = cmd;
+
+	// closed windows only answer queries
+	if (plot != NULL && plot->closed && cmd->kind != CMD_DELETE
+	    && cmd->kind != CMD_GET_STATS) {
+		if (cmd->kind == CMD_SET_TEXT)
+			free(cmd->text);
+		finishCommand(0);
+		return 1;
+	}
+
+	switch (cmd->kind) {
+	case CMD_INIT:
+		// GLFW is shut down again if the window can't be made
+		stopPushers(0);
+		panels = qdspInitGrid(cmd->text, cmd->i[0], cmd->i[1]);
+		if (panels != NULL) {
+			__atomic_store_n(&glfwLive, 1, __ATOMIC_SEQ_CST);
+			for (int i = 0; i < panels[0]->numPanels; i++)
+				panels[i]->threaded = 1;
+
+			QDSPplot **plots = realloc(renderPlots, (numRenderPlots + 1) * sizeof(QDSPplot*));
+			if (plots != NULL) {
+				renderPlots = plots;
+				renderPlots[numRenderPlots++] = panels[0];
+			}
+			result = 1;
+		}
+		cmd->waiter->value = panels;
+		break;
+
+	case CMD_DELETE:
+		// GLFW is shut down with every window in it, so every other threaded
+		// plot goes too
+		stopPushers(1);
+		for (int i = 0; i < numRenderPlots; i++) {
+			panels = renderPlots[i]->panels;
+			if (panels == plot->panels)
+				continue;
+			int numPanels = renderPlots[i]->numPanels;
+			for (int j = 0; j < numPanels; j++)
+				freePanel(panels[j]);
+			free(panels);
+		}
+		qdspDelete(plot);
+		free(renderPlots);
+		renderPlots = NULL;
+		numRenderPlots = 0;
+		finishCommand(1);
+
+		// nothing can be queued now, and what already was fails
+		while ((cmd = popCommand()) != NULL) {
+			renderCommand = cmd;
+			if (cmd->kind == CMD_SET_TEXT)
+				free(cmd->text);
+			finishCommand(0);
+		}
+		return 0;
+
+	case CMD_REDRAW:
+		qdspRedraw(plot);
+		break;
+
+	case CMD_GET_STATS:
+		qdspGetStats(plot, cmd->stats);
+		break;
+
+	case CMD_UPDATE:
+		result = qdspUpdateArraysLarge(plot, &cmd->arrays[0], &cmd->arrays[1],
+		                               cmd->hasColor ? &cmd->arrays[2] : NULL, cmd->numPoints);
+		break;
+
+	case CMD_UPDATE_IF_READY:
+		result = qdspUpdateArraysIfReady(plot, &cmd->arrays[0], &cmd->arrays[1],
+		                                 cmd->hasColor ? &cmd->arrays[2] : NULL, cmd->numPoints);
+		break;
+
+	case CMD_UPDATE_WAIT:
+		result = qdspUpdateArraysWait(plot, &cmd->arrays[0], &cmd->arrays[1],
+		                              cmd->hasColor ? &cmd->arrays[2] : NULL, cmd->numPoints);
+		break;
+
+	case CMD_UPDATE_CURVES:
+		result = qdspUpdateCurves(plot, (double*)cmd->arrays[0].data, (double*)cmd->arrays[1].data,
+		                          cmd->numPoints, cmd->curves[0], cmd->curves[1],
+		                          cmd->curves[2], cmd->numCurves);
+		break;
+
+	case CMD_SET_FRAMERATE:
+		qdspSetFramerate(plot, cmd->d[0]);
+		break;
+
+	case CMD_SET_BOUNDS:
+		qdspSetBounds(plot, cmd->d[0], cmd->d[1], cmd->d[2], cmd->d[3]);
+		break;
+
+	case CMD_SET_AUTO_BOUNDS:
+		qdspSetAutoBounds(plot, cmd->i[0]);
+		break;
+
+	case CMD_SET_HIGH_PRECISION:
+		qdspSetHighPrecision(plot, cmd->i[0]);
+		break;
+
+	case CMD_SET_TEXT:
+		qdspSetText(plot, cmd->i[0], cmd->d[0], cmd->d[1], cmd->text);
+		free(cmd->text);
+		break;
+
+	case CMD_SET_PERSISTENCE:
+		qdspSetPersistence(plot, cmd->d[0]);
+		break;
+
+	case CMD_SET_TRAILS:
+		qdspSetTrails(plot, cmd->i[0], cmd->i[1]);
+		break;
+
+	case CMD_SET_CONNECTED:
+		qdspSetConnected(plot, cmd->i[0]);
+		break;
+
+	case CMD_SET_LINE_STYLE:
+		qdspSetLineStyle(plot, cmd->d[0], cmd->i[0]);
+		break;
+
+	case CMD_SET_POINT_SIZE:
+		qdspSetPointSize(plot, cmd->i[0]);
+		break;
+
+	case CMD_SET_POINT_ALPHA:
+		qdspSetPointAlpha(plot, cmd->d[0]);
+		break;
+
+	case CMD_SET_POINT_COLOR:
+		qdspSetPointColor(plot, cmd->i[0]);
+		break;
+
+	case CMD_SET_BG_COLOR:
+		qdspSetBGColor(plot, cmd->i[0]);
+		break;
+
+	case CMD_SET_GRID_X:
+		qdspSetGridX(plot, cmd->d[0], cmd->d[1], cmd->i[0]);
+		break;
+
+	case CMD_SET_GRID_Y:
+		qdspSetGridY(plot, cmd->d[0], cmd->d[1], cmd->i[0]);
+		break;
+
+	case CMD_SET_OVERHEAD_BUDGET:
+		qdspSetOverheadBudget(plot, cmd->d[0]);
+		break;
+
+	case CMD_SET_HOVER_CALLBACK:
+		qdspSetHoverCallback(plot, cmd->hover, cmd->data);
+		break;
+
+	case CMD_SET_SELECT_CALLBACK:
+		qdspSetSelectCallback(plot, cmd->select, cmd->data);
+		break;
+
+	case CMD_UPDATE_FILTER:
+		result = qdspUpdateFilter(plot, cmd->arrays[0].data ? &cmd->arrays[0] : NULL,
+		                          cmd->arrays[1].data ? &cmd->arrays[1] : NULL, cmd->numPoints);
+		break;
+
+	case CMD_SET_FILTER_RANGE:
+		qdspSetFilterRange(plot, cmd->i[0], cmd->d[0], cmd->d[1]);
+		break;
+
+	case CMD_SET_FILTER_CLASSES:
+		qdspSetFilterClasses(plot, cmd->i[0]);
+		break;
+
+	case CMD_UPDATE_FILE:
+		result = qdspUpdateFile(plot, cmd->text, cmd->columns[0], cmd->columns[1],
+		                        cmd->columns[2], cmd->numRows);
+		break;
+
+	case CMD_SET_SPATIAL_SORT:
+		qdspSetSpatialSort(plot, cmd->i[0]);
+		break;
+
+	case CMD_BEGIN_FRAME:
+		result = qdspBeginFrame(plot, cmd->numPoints, cmd->i[0]);
+		break;
+
+	case CMD_END_FRAME:
+		result = qdspEndFrame(plot);
+		break;
+
+	case CMD_SET_BLEND_MODE:
+		qdspSetBlendMode(plot, cmd->i[0]);
+		break;
+
+	case CMD_SET_GRID_VISIBLE:
+		qdspSetGridVisible(plot, cmd->i[0]);
+		break;
+	}
+
+	// updates have usually finished already, once their data was read
+	finishCommand(result);
+	return 1;
+}
+
+// lets the caller of the running command go on
+static void finishCommand(int result) {
+	QDSPcommand *cmd = renderCommand;
+	if (cmd == NULL)
+		return;
+	renderCommand = NULL;
+
+	if (cmd->ticket != 0)
+		finishTicket(cmd->ticket);
+
+	if (cmd->waiter != NULL) {
+		pthread_mutex_lock(&renderLock);
+		cmd->waiter->result = result;
+		cmd->waiter->done = 1;
+		pthread_cond_broadcast(&renderDone);
+		pthread_mutex_unlock(&renderLock);
+	}
+}
+
+static void finishTicket(long long ticket) {
+	pthread_mutex_lock(&renderLock);
+
+	if (ticket != ticketsDone + 1) {
+		// an earlier ticket hasn't been queued yet
+		if (numAhead == aheadCapacity) {
+			int capacity = aheadCapacity ? 2 * aheadCapacity : 16;
+			long long *ahead = realloc(ticketsAhead, capacity * sizeof(long long));
+			if (ahead == NULL) {
+				fprintf(stderr, "Couldn't record a finished update\n");
+				pthread_mutex_unlock(&renderLock);
+				return;
+			}
+			ticketsAhead = ahead;
+			aheadCapacity = capacity;
+		}
+		ticketsAhead[numAhead++] = ticket;
+	} else {
+		// catch up with any that finished ahead of this one
+		ticketsDone = ticket;
+		for (int i = 0; i < numAhead; i++) {
+			if (ticketsAhead[i] == ticketsDone + 1) {
+				ticketsDone++;
+				ticketsAhead[i] = ticketsAhead[--numAhead];
+				i = -1;
+			}
+		}
+	}
+
+	pthread_cond_broadcast(&renderDone);
+	pthread_mutex_unlock(&renderLock);
+}
+
+// runs commands as they come, and keeps the windows responsive in between
+static void *renderLoop(void *arg) {
+	(void)arg;
+	for (;;) {
+		QDSPcommand *cmd;
+		while ((cmd = popCommand()) != NULL) {
+			if (!runCommand(cmd))
+				return NULL;
+		}
+
+		// no window until the first command makes one
+		if (numRenderPlots == 0) {
+			usleep(1000);
+			continue;
+		}
+
+		glfwWaitEventsTimeout(RENDER_POLL);
+		for (int i = 0; i < numRenderPlots; i++)
+			qdspPoll(renderPlots[i]);
+	}
+}
+
+void qdspRedraw(QDSPplot *plot) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_REDRAW, .plot = plot}, NULL);
+		return;
+	}
+
+	// nothing new, or nowhere to show it: the last frame stays up
+	if (plot->hidden || !windowDirty(plot))
+		return;
+
+	// a panel's point buffers are mapped for a frame, so they can't be drawn
+	// from; the damage stays until qdspEndFrame draws the window
+	if (frameMapped(plot))
+		return;
+
+	glfwMakeContextCurrent(plot->window);
+
+	// every panel is drawn into its part of the back buffer, then they're
+	// all shown with one swap
+	for (int i = 0; i < plot->numPanels; i++) {
+		drawPanel(plot->panels[i]);
+		plot->panels[i]->panelUpdated = 0;
+	}
+
+	glfwSwapBuffers(plot->window);
+}
+
+static void drawPanel(QDSPplot *plot) {
+	updateStats(plot);
+
+	// the grid follows the view, so it's rebuilt once per frame however many
+	// times the view moved
+	if (plot->damage & DAMAGE_GRID) {
+		if (plot->xGridInterval > 0)
+			buildGridX(plot);
+		if (plot->yGridInterval > 0)
+			buildGridY(plot);
+	}
+	int damage = plot->damage;
+	plot->damage = 0;
+	unsigned int *queries = plot->gpuQueries[plot->gpuQueryIdx];
+
+	glViewport(plot->panelX, plot->panelY, plot->width, plot->height);
+	glScissor(plot->panelX, plot->panelY, plot->width, plot->height);
+
+	int rgb = plot->bgColor;
+	glClearColor((0xff & rgb >> 16) / 255.0,
+	             (0xff & rgb >> 8) / 255.0,
+	             (0xff & rgb) / 255.0,
+	             1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// grid
+	glBeginQuery(GL_TIME_ELAPSED, queries[0]);
 	if (plot->grid) {
-		glUseProgram(plot->textProgram);
-		glBindTexture(GL_TEXTURE_2D, plot->numTexture);
-			
-		glBindVertexArray(plot->textVAOx);
-		glDrawArrays(GL_TRIANGLES, 0, 6 * 10 * plot->numGridX);
+		glUseProgram(plot->gridProgram);
+
+		glBindVertexArray(plot->gridVAO);
 
-		glBindVertexArray(plot->textVAOy);
-		glDrawArrays(GL_TRIANGLES, 0, 6 * 10 * plot->numGridY);
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useY"), 0);
+		glDrawArraysInstanced(GL_LINES, 0, 2, plot->numGridX);
+
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useY"), 1);
+		glDrawArraysInstanced(GL_LINES, 0, 2, plot->numGridY);
 	}
+	glEndQuery(GL_TIME_ELAPSED);
 	
-	// help overlay
-	if (plot->overlay) {
+	// points, over the highlighted selection
+	glBeginQuery(GL_TIME_ELAPSED, queries[1]);
+	bindFilter(plot);
+	if (plot->numSelected > 0)
+		drawSelection(plot);
+	if (plot->streaming)
+		drawStream(plot, damage & (DAMAGE_DATA | DAMAGE_UNIFORMS));
+	else if (plot->persistence > 0)
+		drawPersistent(plot);
+	else
+		drawPoints(plot);
+	glEndQuery(GL_TIME_ELAPSED);
+
+	// performance HUD, under its numbers
+	if (plot->hud) {
 		glUseProgram(plot->overlayProgram);
+		glUniform2f(glGetUniformLocation(plot->overlayProgram, "imgDims"),
+		            plot->hudDims[0], plot->hudDims[1]);
 		glBindVertexArray(plot->overlayVAO);
-		glBindTexture(GL_TEXTURE_2D, plot->overlayTexture);
+		glBindTexture(GL_TEXTURE_2D, plot->hudTexture);
 		glDrawArrays(GL_TRIANGLES, 0, 6);
+
+		glUseProgram(plot->gridProgram);
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useLine"), 1);
+		glUniform4f(glGetUniformLocation(plot->gridProgram, "lineColor"),
+		            0.2f, 1.0f, 0.2f, 1.0f);
+		glBindVertexArray(plot->hudGraphVAO);
+		glDrawArrays(GL_LINE_STRIP, 0, QDSP_HUD_SAMPLES);
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useLine"), 0);
+	}
+
+	// all text, in one draw
+	glBeginQuery(GL_TIME_ELAPSED, queries[2]);
+	if (plot->textDirty)
+		updateText(plot);
+	if (plot->numGlyphs > 0) {
+		glUseProgram(plot->textProgram);
+		glBindTexture(GL_TEXTURE_2D, plot->textTexture);
+		glBindVertexArray(plot->textVAO);
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, plot->numGlyphs);
+	}
+	glEndQuery(GL_TIME_ELAPSED);
+
+	// results are read back a frame later, so we don't stall
+	plot->gpuQueryUsed[plot->gpuQueryIdx] = 1;
+	plot->gpuQueryIdx = !plot->gpuQueryIdx;
+
+	// box zoom outline
+	if (plot->boxing) {
+		glUseProgram(plot->gridProgram);
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useLine"), 1);
+		glUniform4f(glGetUniformLocation(plot->gridProgram, "lineColor"),
+		            0.5f, 0.5f, 0.5f, 1.0f);
+		glBindVertexArray(plot->boxVAO);
+		glDrawArrays(GL_LINE_LOOP, 0, 4);
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useLine"), 0);
+	}
+
+	// lasso outline, so far
+	if (plot->lassoing && plot->numLasso > 1) {
+		glUseProgram(plot->gridProgram);
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useLine"), 1);
+		glUniform4f(glGetUniformLocation(plot->gridProgram, "lineColor"),
+		            0.5f, 0.5f, 0.5f, 1.0f);
+		glBindVertexArray(plot->lassoVAO);
+		glDrawArrays(GL_LINE_STRIP, 0, plot->numLasso);
+		glUniform1i(glGetUniformLocation(plot->gridProgram, "useLine"), 0);
 	}
 	
-	glfwSwapBuffers(plot->window);
+	// help overlay
+	if (plot->overlay) {
+		glUseProgram(plot->overlayProgram);
+		glUniform2f(glGetUniformLocation(plot->overlayProgram, "imgDims"),
+		            plot->helpDims[0], plot->helpDims[1]);
+		glBindVertexArray(plot->overlayVAO);
+		glBindTexture(GL_TEXTURE_2D, plot->overlayTexture);
+		glDrawArrays(GL_TRIANGLES, 0, 6);
+	}
+}
+
+// whether any panel in the window needs redrawing
+static int windowDirty(QDSPplot *plot) {
+	for (int i = 0; i < plot->numPanels; i++) {
+		if (plot->panels[i]->damage)
+			return 1;
+	}
+	return 0;
+}
+
+// for changes every panel in the window has to show
+static void damageWindow(QDSPplot *plot, int damage) {
+	for (int i = 0; i < plot->numPanels; i++)
+		plot->panels[i]->damage |= damage;
+}
+
+// whether every panel in the window has new data since it was last drawn
+static int allUpdated(QDSPplot *plot) {
+	for (int i = 0; i < plot->numPanels; i++) {
+		if (!plot->panels[i]->panelUpdated)
+			return 0;
+	}
+	return 1;
+}
+
+void qdspGetStats(QDSPplot *plot, QDSPstats *stats) {
+	if (offThread(plot)) {
+		QDSPcommand cmd = {.kind = CMD_GET_STATS, .plot = plot, .stats = stats};
+		postCommand(&cmd, &(QDSPwaiter){0});
+		return;
+	}
+
+	*stats = plot->stats;
+}
+
+void qdspSetFramerate(QDSPplot *plot, double framerate) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_FRAMERATE, .plot = plot, .d = {framerate}}, NULL);
+		return;
+	}
+
+	if (framerate <= 0)
+		plot->frameInterval = 0;
+	else
+		plot->frameInterval = 1000.0 / framerate;
+}
+
+void qdspSetOverheadBudget(QDSPplot *plot, double fraction) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_OVERHEAD_BUDGET, .plot = plot,
+		                             .d = {fraction}}, NULL);
+		return;
+	}
+
+	if (fraction >= 1)
+		fraction = 0;
+
+	// start over from every frame and every point
+	plot->overheadBudget = fraction > 0 ? fraction : 0;
+	plot->budgetInterval = 0;
+	if (plot->budgetStride != 1)
+		plot->trailFilled = 0;
+	plot->budgetStride = 1;
+	plot->stats.budgetFps = 0;
+	plot->stats.pointStride = 1;
+}
+
+void qdspSetBounds(QDSPplot *plot, double xMin, double xMax, double yMin, double yMax) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_BOUNDS, .plot = plot,
+		                             .d = {xMin, xMax, yMin, yMax}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+
+	plot->homeXMin = xMin;
+	plot->homeXMax = xMax;
+	plot->homeYMin = yMin;
+	plot->homeYMax = yMax;
+
+	// don't yank the view away from someone who's zoomed in
+	if (plot->userView)
+		return;
+
+	setView(plot, xMin, xMax, yMin, yMax);
 }
 
-void qdspSetFramerate(QDSPplot *plot, double framerate) {
-	if (framerate <= 0)
-		plot->frameInterval = 0;
-	else
-		plot->frameInterval = 1000.0 / framerate;
+void qdspSetAutoBounds(QDSPplot *plot, int mode) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_AUTO_BOUNDS, .plot = plot, .i = {mode}}, NULL);
+		return;
+	}
+
+	plot->autoBounds = mode;
+
+	// forget the old range, so percentiles start from a fresh histogram
+	memset(plot->autoRange, 0, sizeof(plot->autoRange));
+}
+
+void qdspSetHighPrecision(QDSPplot *plot, int enabled) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_HIGH_PRECISION, .plot = plot, .i = {enabled}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+
+	plot->highPrecision = enabled;
+	plot->xOrigin = 0;
+	plot->yOrigin = 0;
+	if (enabled)
+		recenter(plot);
+	setViewUniforms(plot);
+	setFilterUniforms(plot);
+
+	// positions are floats in high precision mode, doubles otherwise; thick
+	// lines and highlights read the raw bits (the first segment's textures
+	// are the lines')
+	GLenum type = enabled ? GL_FLOAT : GL_DOUBLE;
+	GLenum format = enabled ? GL_R32UI : GL_RG32UI;
+	for (int k = 0; k < plot->segmentCapacity; k++) {
+		struct QDSPsegment *seg = &plot->segments[k];
+		glBindVertexArray(seg->vao);
+		for (int i = 0; i < 2; i++) {
+			glBindBuffer(GL_ARRAY_BUFFER, seg->vbos[i]);
+			glVertexAttribPointer(i, 1, type, GL_FALSE, 0, NULL);
+
+			glBindTexture(GL_TEXTURE_BUFFER, seg->textures[i]);
+			glTexBuffer(GL_TEXTURE_BUFFER, format, seg->vbos[i]);
+		}
+	}
+
+	glUseProgram(plot->linesProgram);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "useDouble"), !enabled);
+
+	// old trail positions have the wrong format and origin
+	for (int i = 0; i < 2; i++) {
+		glBindTexture(GL_TEXTURE_BUFFER, plot->trailTextures[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, format, plot->trailVBOs[i]);
+	}
+	glUseProgram(plot->trailsProgram);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "useDouble"), !enabled);
+	plot->trailFilled = 0;
+
+	glUseProgram(plot->highlightProgram);
+	glUniform1i(glGetUniformLocation(plot->highlightProgram, "useDouble"), !enabled);
+
+	// whatever's in the buffers is in the wrong format now
+	plot->numPoints = 0;
+	plot->damage |= DAMAGE_DATA;
+}
+
+void qdspSetText(QDSPplot *plot, int slot, double x, double y, const char *text) {
+	if (slot < 0 || slot >= QDSP_MAX_TEXT)
+		return;
+
+	if (offThread(plot)) {
+		// the render thread gets its own copy of the text
+		QDSPcommand cmd = {.kind = CMD_SET_TEXT, .plot = plot, .i = {slot}, .d = {x, y}};
+		if (text != NULL && (cmd.text = strdup(text)) == NULL)
+			return;
+		postCommand(&cmd, NULL);
+		return;
+	}
+
+	if (text == NULL) {
+		free(plot->text[slot]);
+		plot->text[slot] = NULL;
+	} else {
+		int len = strlen(text);
+		plot->text[slot] = realloc(plot->text[slot], len + 1);
+		memcpy(plot->text[slot], text, len + 1);
+		plot->textPos[slot][0] = x;
+		plot->textPos[slot][1] = y;
+	}
+
+	plot->textDirty = 1;
+	plot->damage |= DAMAGE_OVERLAY;
+}
+
+void qdspSetPersistence(QDSPplot *plot, double decay) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_PERSISTENCE, .plot = plot, .d = {decay}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+
+	if (decay < 0) decay = 0;
+	if (decay > 1) decay = 1;
+
+	if (decay > 0 && plot->persistFBO == 0)
+		resizePersistent(plot);
+
+	plot->persistence = decay;
+	plot->persistClear = 1;
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetTrails(QDSPplot *plot, int length, int count) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_TRAILS, .plot = plot, .i = {length, count}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+
+	if (length < 2 || count < 1) {
+		length = 0;
+		count = 0;
+	}
+
+	plot->trailLength = length;
+	plot->trailCount = count;
+	plot->trailHead = 0;
+	plot->trailFilled = 0;
+
+	// sized for doubles, so switching precision doesn't need a reallocation
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_COPY_WRITE_BUFFER, plot->trailVBOs[i]);
+		glBufferData(GL_COPY_WRITE_BUFFER, (size_t)length * count * sizeof(double),
+		             NULL, GL_DYNAMIC_COPY);
+	}
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetConnected(QDSPplot *plot, int connected) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_CONNECTED, .plot = plot, .i = {connected}}, NULL);
+		return;
+	}
+
+	plot->connected = connected;
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetSpatialSort(QDSPplot *plot, int enabled) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_SPATIAL_SORT, .plot = plot, .i = {enabled}}, NULL);
+		return;
+	}
+
+	// takes effect with the next update, which lets go of the order once
+	// sorting's off
+	plot->spatialSort = enabled;
+}
+
+void qdspSetBlendMode(QDSPplot *plot, int mode) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_BLEND_MODE, .plot = plot, .i = {mode}}, NULL);
+		return;
+	}
+
+	if (mode != QDSP_BLEND_ALPHA && mode != QDSP_BLEND_ADD) {
+		fprintf(stderr, "Unknown blend mode %d\n", mode);
+		return;
+	}
+
+	plot->blendMode = mode;
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetLineStyle(QDSPplot *plot, double width, int join) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_LINE_STYLE, .plot = plot,
+		                             .d = {width}, .i = {join}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+
+	if (width <= 0) return;
+
+	glUseProgram(plot->linesProgram);
+	glUniform1f(glGetUniformLocation(plot->linesProgram, "halfWidth"), width / 2);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "roundJoin"), join == QDSP_JOIN_ROUND);
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetPointSize(QDSPplot *plot, int pixels) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_POINT_SIZE, .plot = plot, .i = {pixels}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+	
+	glUseProgram(plot->pointsProgram);
+	glUniform1i(glGetUniformLocation(plot->pointsProgram, "pointSize"), pixels);
+
+	// picked the same size, highlighted a bit bigger
+	glUseProgram(plot->pickProgram);
+	glUniform1i(glGetUniformLocation(plot->pickProgram, "pointSize"), pixels);
+	glUseProgram(plot->highlightProgram);
+	glUniform1i(glGetUniformLocation(plot->highlightProgram, "pointSize"),
+	            pixels + HIGHLIGHT_PIXELS);
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetPointAlpha(QDSPplot *plot, double alpha) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_POINT_ALPHA, .plot = plot, .d = {alpha}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+	
+	int programs[] = {plot->pointsProgram, plot->linesProgram, plot->trailsProgram};
+	for (int i = 0; i < 3; i++) {
+		glUseProgram(programs[i]);
+		glUniform1f(glGetUniformLocation(programs[i], "alpha"), alpha);
+	}
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetPointColor(QDSPplot *plot, int rgb) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_POINT_COLOR, .plot = plot, .i = {rgb}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+	
+	int programs[] = {plot->pointsProgram, plot->linesProgram, plot->trailsProgram};
+	for (int i = 0; i < 3; i++) {
+		glUseProgram(programs[i]);
+		glUniform1i(glGetUniformLocation(programs[i], "defaultColor"), rgb);
+	}
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetBGColor(QDSPplot *plot, int rgb) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_BG_COLOR, .plot = plot, .i = {rgb}}, NULL);
+		return;
+	}
+
+	// the clear color is shared by all panels, so it's set when drawing
+	plot->bgColor = rgb;
+	plot->damage |= DAMAGE_UNIFORMS;
+}
+
+void qdspSetGridX(QDSPplot *plot, double point, double interval, int rgb) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_GRID_X, .plot = plot,
+		                             .d = {point, interval}, .i = {rgb}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+	
+	if (interval <= 0) return;
+
+	plot->xAutoGrid = 0;
+	plot->xGridPoint = point;
+	plot->xGridInterval = interval;
+	plot->xGridColor = rgb;
+	plot->damage |= DAMAGE_GRID;
+}
+
+void qdspSetGridY(QDSPplot *plot, double point, double interval, int rgb) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_GRID_Y, .plot = plot,
+		                             .d = {point, interval}, .i = {rgb}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+	
+	if (interval <= 0) return;
+
+	plot->yAutoGrid = 0;
+	plot->yGridPoint = point;
+	plot->yGridInterval = interval;
+	plot->yGridColor = rgb;
+	plot->damage |= DAMAGE_GRID;
+}
+
+void qdspSetGridVisible(QDSPplot *plot, int visible) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_GRID_VISIBLE, .plot = plot,
+		                             .i = {visible}}, NULL);
+		return;
+	}
+
+	// same as pressing 'g', which toggles it
+	plot->grid = !!visible;
+	plot->textDirty = 1;
+	plot->damage |= DAMAGE_GRID;
+}
+
+void qdspSetHoverCallback(QDSPplot *plot, QDSPhoverCallback callback, void *data) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_HOVER_CALLBACK, .plot = plot,
+		                             .hover = callback, .data = data}, NULL);
+		return;
+	}
+
+	plot->hoverCallback = callback;
+	plot->hoverData = data;
+	plot->hovered = -1;
+
+	// the cursor may already be over a point
+	plot->pickPending = (callback != NULL);
+}
+
+void qdspSetSelectCallback(QDSPplot *plot, QDSPselectCallback callback, void *data) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_SELECT_CALLBACK, .plot = plot,
+		                             .select = callback, .data = data}, NULL);
+		return;
+	}
+
+	plot->selectCallback = callback;
+	plot->selectData = data;
+}
+
+void qdspSetFilterRange(QDSPplot *plot, int attribute, double min, double max) {
+	if (attribute < QDSP_FILTER_X || attribute > QDSP_FILTER_VALUE)
+		return;
+
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_FILTER_RANGE, .plot = plot,
+		                             .i = {attribute}, .d = {min, max}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+
+	plot->filterRange[attribute][0] = min;
+	plot->filterRange[attribute][1] = max;
+	setFilterUniforms(plot);
+	plot->damage |= DAMAGE_UNIFORMS;
+
+	// the point under the cursor may be hidden now
+	if (plot->hoverCallback)
+		plot->pickPending = 1;
+}
+
+void qdspSetFilterClasses(QDSPplot *plot, unsigned int classes) {
+	if (offThread(plot)) {
+		postCommand(&(QDSPcommand){.kind = CMD_SET_FILTER_CLASSES, .plot = plot,
+		                             .i = {classes}}, NULL);
+		return;
+	}
+
+	glfwMakeContextCurrent(plot->window);
+
+	plot->filterClasses = classes;
+	setFilterUniforms(plot);
+	plot->damage |= DAMAGE_UNIFORMS;
+
+	if (plot->hoverCallback)
+		plot->pickPending = 1;
+}
+
+static void setView(QDSPplot *plot, double xMin, double xMax, double yMin, double yMax) {
+	plot->xMin = xMin;
+	plot->xMax = xMax;
+	plot->yMin = yMin;
+	plot->yMax = yMax;
+	setViewUniforms(plot);
+
+	// if no grid has been set, we need to make sure it doesn't look like crap
+	if (plot->xAutoGrid) {
+		plot->xGridPoint = xMin;
+		plot->xGridInterval = (xMax - xMin) / 4;
+		plot->xGridColor = 0x000000;
+	}
+
+	if (plot->yAutoGrid) {
+		plot->yGridPoint = yMin;
+		plot->yGridInterval = (yMax - yMin) / 4;
+		plot->yGridColor = 0x000000;
+	}
+
+	// trails from the old view would be in the wrong place
+	plot->persistClear = 1;
+
+	// gridlines are stored in screen coordinates, so they follow the view
+	plot->damage |= DAMAGE_UNIFORMS | DAMAGE_GRID;
+}
+
+// bounds are relative to the origin, which is only nonzero in high precision
+// mode; subtracting in double keeps small views far from 0 sharp
+static void setViewUniforms(QDSPplot *plot) {
+	int programs[] = {plot->pointsProgram, plot->linesProgram, plot->trailsProgram,
+	                  plot->pickProgram, plot->selectProgram, plot->highlightProgram};
+	for (int i = 0; i < 6; i++) {
+		glUseProgram(programs[i]);
+		glUniform1f(glGetUniformLocation(programs[i], "xMin"), plot->xMin - plot->xOrigin);
+		glUniform1f(glGetUniformLocation(programs[i], "xMax"), plot->xMax - plot->xOrigin);
+		glUniform1f(glGetUniformLocation(programs[i], "yMin"), plot->yMin - plot->yOrigin);
+		glUniform1f(glGetUniformLocation(programs[i], "yMax"), plot->yMax - plot->yOrigin);
+	}
+}
+
+static void setFilterUniforms(QDSPplot *plot) {
+	// position ranges are relative to the origin, like the positions
+	double origin[] = {plot->xOrigin, plot->yOrigin, 0};
+	float ranges[3][2];
+	for (int i = 0; i < 3; i++) {
+		ranges[i][0] = plot->filterRange[i][0] - origin[i];
+		ranges[i][1] = plot->filterRange[i][1] - origin[i];
+	}
+
+	int programs[] = {plot->pointsProgram, plot->linesProgram, plot->trailsProgram,
+	                  plot->pickProgram, plot->selectProgram, plot->highlightProgram};
+	for (int i = 0; i < 6; i++) {
+		glUseProgram(programs[i]);
+		glUniform2fv(glGetUniformLocation(programs[i], "xRange"), 1, ranges[0]);
+		glUniform2fv(glGetUniformLocation(programs[i], "yRange"), 1, ranges[1]);
+		glUniform2fv(glGetUniformLocation(programs[i], "valueRange"), 1, ranges[2]);
+		glUniform1ui(glGetUniformLocation(programs[i], "classes"), plot->filterClasses);
+		glUniform1i(glGetUniformLocation(programs[i], "useValues"), plot->hasValues);
+		glUniform1i(glGetUniformLocation(programs[i], "useMask"), plot->hasMask);
+		glUniform1i(glGetUniformLocation(programs[i], "numFiltered"), plot->numFiltered);
+	}
+}
+
+// filter data for the shaders; panels share texture units, so each binds its
+// own before drawing
+static void bindFilter(QDSPplot *plot) {
+	for (int i = 0; i < 2; i++) {
+		glActiveTexture(GL_TEXTURE6 + i);
+		glBindTexture(GL_TEXTURE_BUFFER, plot->filterTextures[i]);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+// gridlines are drawn procedurally: line i of the grid program is placed at
+// first + i * step, so a new view only costs a uniform and the labels, which
+// are rebuilt here along with it
+static void buildGridX(QDSPplot *plot) {
+	double first, step;
+	int numLines = gridLines(plot->xGridPoint, plot->xGridInterval,
+	                         plot->xMin, plot->xMax, &first, &step);
+	double span = plot->xMax - plot->xMin;
+	int rgb = plot->xGridColor;
+	plot->numGridX = numLines;
+
+	struct QDSPglyph *labels = plot->gridGlyphs[0];
+	for (int i = 0; i < numLines; i++) {
+		double x = first + i * step;
+		double xNorm = 2 * (x - plot->xMin) / span - 1;
+
+		char str[GRID_LABEL_CHARS + 1];
+		snprintf(str, GRID_LABEL_CHARS + 1, "% .3e", x);
+		
+		int off = (i == 0); // to prevent overlap, offset bottom left by 1
+		for (int j = 0; j < GRID_LABEL_CHARS; j++)
+			glyphHelper(&labels[GRID_LABEL_CHARS*i + j], xNorm, -1, off + j, 0, str[j]);
+	}
+	plot->numGridGlyphs[0] = GRID_LABEL_CHARS * numLines;
+	plot->textDirty = 1;
+
+	glUseProgram(plot->gridProgram);
+
+	// first line and spacing, in normalized device coordinates
+	glUniform2f(glGetUniformLocation(plot->gridProgram, "xLines"),
+	            2 * (first - plot->xMin) / span - 1, 2 * step / span);
+
+	// pass rgba
+	glUniform4f(glGetUniformLocation(plot->gridProgram, "xColor"),
+	            (0xff & rgb >> 16) / 255.0,
+	            (0xff & rgb >> 8) / 255.0,
+	            (0xff & rgb) / 255.0,
+	            1.0f);
+}
+
+static void buildGridY(QDSPplot *plot) {
+	double first, step;
+	int numLines = gridLines(plot->yGridPoint, plot->yGridInterval,
+	                         plot->yMin, plot->yMax, &first, &step);
+	double span = plot->yMax - plot->yMin;
+	int rgb = plot->yGridColor;
+	plot->numGridY = numLines;
+
+	struct QDSPglyph *labels = plot->gridGlyphs[1];
+	for (int i = 0; i < numLines; i++) {
+		double y = first + i * step;
+		double yNorm = 2 * (y - plot->yMin) / span - 1;
+
+		char str[GRID_LABEL_CHARS + 1];
+		snprintf(str, GRID_LABEL_CHARS + 1, "% .3e", y);
+		
+		int off = (i == 0);
+		for (int j = 0; j < GRID_LABEL_CHARS; j++)
+			glyphHelper(&labels[GRID_LABEL_CHARS*i + j], -1, yNorm, j, off, str[j]);
+	}
+	plot->numGridGlyphs[1] = GRID_LABEL_CHARS * numLines;
+	plot->textDirty = 1;
+
+	glUseProgram(plot->gridProgram);
+
+	glUniform2f(glGetUniformLocation(plot->gridProgram, "yLines"),
+	            2 * (first - plot->yMin) / span - 1, 2 * step / span);
+
+	// pass rgba
+	glUniform4f(glGetUniformLocation(plot->gridProgram, "yColor"),
+	            (0xff & rgb >> 16) / 255.0,
+	            (0xff & rgb >> 8) / 255.0,
+	            (0xff & rgb) / 255.0,
+	            1.0f);
+}
+
+// finds the first gridline in [min, max] and the spacing between lines,
+// returning the number of lines
+static int gridLines(double point, double interval, double min, double max,
+                     double *first, double *step) {
+	// zoomed far out, skip lines so we don't draw thousands of labels
+	double skip = ceil((max - min) / interval / GRID_MAX_LINES);
+	if (skip > 1) interval *= skip;
+
+	// indices stay doubles, the point can be far away from the view
+	double iMin = ceil((min - point) / interval);
+	double iMax = floor((max - point) / interval);
+	double numLines = iMax - iMin + 1;
+	if (numLines < 0) numLines = 0;
+	if (numLines > GRID_MAX_LABELS) numLines = GRID_MAX_LABELS;
+
+	*first = point + iMin * interval;
+	*step = interval;
+	return (int)numLines;
+}
+
+// copies the newest positions of the trailed points into the ring, without
+// them leaving the GPU
+static void pushTrail(QDSPplot *plot) {
+	// not enough points this time, so they can't be the same particles;
+	// trailed points also have to be in the first segment
+	if (segmentSize(plot, 0) < (size_t)plot->trailCount) {
+		plot->trailFilled = 0;
+		return;
+	}
+
+	size_t coordSize = plot->highPrecision ? sizeof(float) : sizeof(double);
+	size_t frameSize = plot->trailCount * coordSize;
+	plot->trailHead = (plot->trailHead + 1) % plot->trailLength;
+
+	unsigned int src[] = {plot->pointsVBOx, plot->pointsVBOy};
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_COPY_READ_BUFFER, src[i]);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, plot->trailVBOs[i]);
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+		                    0, plot->trailHead * frameSize, frameSize);
+	}
+
+	if (plot->trailFilled < plot->trailLength)
+		plot->trailFilled++;
+}
+
+// one instance per particle, a segment between each pair of frames in the ring
+static void drawTrails(QDSPplot *plot) {
+	glUseProgram(plot->trailsProgram);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "trailLength"), plot->trailLength);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "head"), plot->trailHead);
+	glUniform1i(glGetUniformLocation(plot->trailsProgram, "count"), plot->trailCount);
+	glBindVertexArray(plot->trailsVAO);
+
+	for (int i = 0; i < 2; i++) {
+		glActiveTexture(GL_TEXTURE1 + i);
+		glBindTexture(GL_TEXTURE_BUFFER, plot->trailTextures[i]);
+	}
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_BUFFER, plot->lineTextures[2]);
+	glActiveTexture(GL_TEXTURE0);
+
+	glDrawArraysInstanced(GL_LINES, 0, 2 * (plot->trailFilled - 1), plot->trailCount);
+}
+
+// points, or lines in connected mode and for separate curves
+static void drawPoints(QDSPplot *plot) {
+	// trails go under the points
+	if (plot->trailFilled > 1)
+		drawTrails(plot);
+
+	// sums don't depend on the order points are drawn in; the alpha channel
+	// only matters in the persistence buffer, where it saturates
+	if (plot->blendMode == QDSP_BLEND_ADD)
+		glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE, GL_ONE, GL_ONE);
+
+	int lines = plot->connected || plot->curveMode;
+	if (lines && plot->numSegments == 1 && plot->numPoints > 1 &&
+	    plot->numPoints <= (size_t)plot->maxLinePoints) {
+		// thick lines, one instance per segment, all curves at once
+		glUseProgram(plot->linesProgram);
+		glUniform1i(glGetUniformLocation(plot->linesProgram, "numPoints"), plot->numPoints);
+		glUniform1i(glGetUniformLocation(plot->linesProgram, "useCurves"), plot->curveMode);
+		glBindVertexArray(plot->linesVAO);
+		for (int i = 0; i < 4; i++) {
+			glActiveTexture(GL_TEXTURE1 + i);
+			glBindTexture(GL_TEXTURE_BUFFER, plot->lineTextures[i]);
+		}
+		glActiveTexture(GL_TEXTURE0);
+		if (!plot->curveMode || plot->numCurves > 0)
+			glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, plot->numPoints - 1);
+	} else if (plot->curveMode) {
+		// too big for texture buffers: 1px strips, in the default color
+		glUseProgram(plot->pointsProgram);
+		glUniform1i(glGetUniformLocation(plot->pointsProgram, "base"), 0);
+		if (plot->numSegments == 1) {
+			glBindVertexArray(plot->pointsVAO);
+			glMultiDrawArrays(GL_LINE_STRIP, plot->curveFirst, plot->curveCount, plot->numCurves);
+		} else {
+			drawCurveSegments(plot);
+		}
+	} else {
+		// a draw per segment; they're big enough that there are only a few
+		glUseProgram(plot->pointsProgram);
+		int base = glGetUniformLocation(plot->pointsProgram, "base");
+		for (int k = 0; k < plot->numSegments; k++) {
+			glUniform1i(base, segmentIndex(plot, k));
+			glBindVertexArray(plot->segments[k].vao);
+			glDrawArrays(plot->connected ? GL_LINE_STRIP : GL_POINTS,
+			             0, segmentSize(plot, k));
+		}
+	}
+
+	if (plot->blendMode == QDSP_BLEND_ADD)
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// curves are cut at the edges of the segments, which overlap by a point so
+// the pieces meet; each segment's pieces are drawn at once
+static void drawCurveSegments(QDSPplot *plot) {
+	int *first = malloc(plot->numCurves * sizeof(int));
+	int *count = malloc(plot->numCurves * sizeof(int));
+	if (first == NULL || count == NULL) {
+		free(first);
+		free(count);
+		return;
+	}
+
+	int base = glGetUniformLocation(plot->pointsProgram, "base");
+	for (int k = 0; k < plot->numSegments; k++) {
+		size_t lo = segmentBase(plot, k);
+		size_t hi = lo + segmentSize(plot, k);
+		int n = 0;
+		for (int i = 0; i < plot->numCurves; i++) {
+			size_t start = plot->curveFirst[i];
+			size_t end = start + plot->curveCount[i];
+			if (start < lo)
+				start = lo;
+			if (end > hi)
+				end = hi;
+			if (end > start + 1) {
+				first[n] = start - lo;
+				count[n] = end - start;
+				n++;
+			}
+		}
+
+		glUniform1i(base, segmentIndex(plot, k));
+		glBindVertexArray(plot->segments[k].vao);
+		glMultiDrawArrays(GL_LINE_STRIP, first, count, n);
+	}
+
+	free(first);
+	free(count);
+}
+
+// the selected points, fetched by index from the point buffers; each segment
+// draws the ones it holds
+static void drawSelection(QDSPplot *plot) {
+	glUseProgram(plot->highlightProgram);
+	glBindVertexArray(plot->selectVAO);
+	for (int k = 0; k < plot->numSegments && segmentIndex(plot, k) >= 0; k++) {
+		glUniform1i(glGetUniformLocation(plot->highlightProgram, "base"), segmentIndex(plot, k));
+		glUniform1i(glGetUniformLocation(plot->highlightProgram, "numPoints"), segmentSize(plot, k));
+		for (int i = 0; i < 2; i++) {
+			glActiveTexture(GL_TEXTURE1 + i);
+			glBindTexture(GL_TEXTURE_BUFFER, plot->segments[k].textures[i]);
+		}
+		glDrawArrays(GL_POINTS, 0, plot->numSelected);
+	}
+	glActiveTexture(GL_TEXTURE0);
+}
+
+// draws the points into the persistence buffer, after fading what's there,
+// then draws the buffer over the window
+static void drawPersistent(QDSPplot *plot) {
+	float zero[] = {0, 0, 0, 0};
+	double decay = plot->persistence;
+
+	// the buffer is the size of the panel, not the window
+	glBindFramebuffer(GL_FRAMEBUFFER, plot->persistFBO);
+	glViewport(0, 0, plot->width, plot->height);
+	glDisable(GL_SCISSOR_TEST);
+	glUseProgram(plot->persistProgram);
+	glBindVertexArray(plot->persistVAO);
+
+	if (plot->persistClear) {
+		glClearBufferfv(GL_COLOR, 0, zero);
+		plot->persistClear = 0;
+	} else {
+		// one pass multiplies everything by the decay factor; the texture is
+		// unbound, since it's the one we're drawing to
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glBlendColor(decay, decay, decay, decay);
+		glBlendFunc(GL_ZERO, GL_CONSTANT_COLOR);
+		glDrawArrays(GL_TRIANGLES, 0, 3);
+	}
+
+	// keep colors premultiplied, so the fade and the final blend are right
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+	                    GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	drawPoints(plot);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(plot->panelX, plot->panelY, plot->width, plot->height);
+	glEnable(GL_SCISSOR_TEST);
+	glUseProgram(plot->persistProgram);
+	glBindVertexArray(plot->persistVAO);
+	glBindTexture(GL_TEXTURE_2D, plot->persistTexture);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// (re)allocates the persistence buffer at the panel size
+static void resizePersistent(QDSPplot *plot) {
+	resizeTarget(plot, &plot->persistFBO, &plot->persistTexture);
+	plot->persistClear = 1;
+}
+
+// (re)allocates an offscreen target at the panel size, creating it if *fbo is 0
+static void resizeTarget(QDSPplot *plot, unsigned int *fbo, unsigned int *texture) {
+	if (*fbo == 0) {
+		glGenFramebuffers(1, fbo);
+		glGenTextures(1, texture);
+	}
+
+	// half floats, so faint trails keep fading instead of getting stuck, and
+	// many faint points can add up
+	glBindTexture(GL_TEXTURE_2D, *texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, plot->width, plot->height, 0,
+	             GL_RGBA, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, *fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+	                       *texture, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// the ring of stream buffers, each with its own vertex array, and the target
+// chunks are drawn into
+static void initStream(QDSPplot *plot) {
+	glGenVertexArrays(QDSP_STREAM_BUFFERS, plot->streamVAOs);
+	for (int i = 0; i < QDSP_STREAM_BUFFERS; i++) {
+		glGenBuffers(3, plot->streamVBOs[i]);
+		glBindVertexArray(plot->streamVAOs[i]);
+
+		// positions are always float offsets from the origin
+		for (int j = 0; j < 2; j++) {
+			glBindBuffer(GL_ARRAY_BUFFER, plot->streamVBOs[i][j]);
+			glBufferData(GL_ARRAY_BUFFER, STREAM_CHUNK * sizeof(float), NULL, GL_STREAM_DRAW);
+			glVertexAttribPointer(j, 1, GL_FLOAT, GL_FALSE, 0, NULL);
+			glEnableVertexAttribArray(j);
+		}
+
+		glBindBuffer(GL_ARRAY_BUFFER, plot->streamVBOs[i][2]);
+		glBufferData(GL_ARRAY_BUFFER, STREAM_CHUNK * sizeof(int), NULL, GL_STREAM_DRAW);
+		glVertexAttribIPointer(2, 1, GL_INT, 0, NULL);
+		glEnableVertexAttribArray(2);
+	}
+
+	resizeTarget(plot, &plot->streamFBO, &plot->streamTexture);
+}
+
+// unmaps the file; the buffers and target are kept for the next one
+static void endStream(QDSPplot *plot) {
+	if (!plot->streaming)
+		return;
+
+	if (plot->streamMap != NULL)
+		munmap(plot->streamMap, plot->streamSize);
+	plot->streamMap = NULL;
+	plot->streaming = 0;
+	plot->damage |= DAMAGE_DATA;
+}
+
+// draws the streamed points over the window, streaming the file into the
+// target again first if the view or point style changed
+static void drawStream(QDSPplot *plot, int restream) {
+	if (restream)
+		streamFile(plot);
+
+	glUseProgram(plot->persistProgram);
+	glBindVertexArray(plot->persistVAO);
+	glBindTexture(GL_TEXTURE_2D, plot->streamTexture);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+// converts the file a chunk at a time into the ring of buffers, drawing each
+// chunk once it's copied; a buffer is only refilled once the GPU is done
+// drawing from it, so the CPU converts one chunk while the GPU draws the last
+static void streamFile(QDSPplot *plot) {
+	float zero[] = {0, 0, 0, 0};
+	const QDSPkernels *kernels = qdspKernels();
+	int hasColor = plot->streamHasColor;
+	int numColumns = hasColor ? 3 : 2;
+
+	if (plot->highPrecision)
+		recenter(plot);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, plot->streamFBO);
+	glViewport(0, 0, plot->width, plot->height);
+	glDisable(GL_SCISSOR_TEST);
+	glClearBufferfv(GL_COLOR, 0, zero);
+
+	// premultiplied, like the persistence buffer; filter data belongs to
+	// the arrays of other updates, so only positions are filtered
+	glUseProgram(plot->pointsProgram);
+	glUniform1i(glGetUniformLocation(plot->pointsProgram, "useCustom"), hasColor);
+	glUniform1i(glGetUniformLocation(plot->pointsProgram, "numFiltered"), 0);
+	glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA,
+	                    GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	long long total = plot->streamPoints;
+	for (long long start = 0, n = 0; start < total; start += STREAM_CHUNK, n++) {
+		int slot = n % QDSP_STREAM_BUFFERS;
+		int len = (total - start < STREAM_CHUNK) ? total - start : STREAM_CHUNK;
+
+		if (plot->streamFences[slot] != NULL) {
+			GLenum status;
+			do {
+				status = glClientWaitSync(plot->streamFences[slot],
+				                          GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_WAIT);
+			} while (status == GL_TIMEOUT_EXPIRED);
+			glDeleteSync(plot->streamFences[slot]);
+			plot->streamFences[slot] = NULL;
+		}
+
+		// the next chunk is read in while this one is converted
+		if (start + len < total)
+			adviseRows(plot, start + len, STREAM_CHUNK, MADV_WILLNEED);
+
+		// the buffer's free, so there's nothing to synchronize with; if
+		// mapping fails, a chunk of scratch memory is copied in instead
+		void *dst[3] = {NULL};
+		int mapped[3];
+		size_t sizes[] = {len * sizeof(float), len * sizeof(float), len * sizeof(int)};
+		for (int i = 0; i < numColumns; i++) {
+			glBindBuffer(GL_ARRAY_BUFFER, plot->streamVBOs[slot][i]);
+			dst[i] = glMapBufferRange(GL_ARRAY_BUFFER, 0, sizes[i],
+			                          GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+			                          GL_MAP_UNSYNCHRONIZED_BIT);
+			if (!(mapped[i] = (dst[i] != NULL)))
+				dst[i] = malloc(sizes[i]);
+		}
+		if (dst[0] == NULL || dst[1] == NULL || (hasColor && dst[2] == NULL)) {
+			fprintf(stderr, "Couldn't allocate stream buffers\n");
+			for (int i = 0; i < numColumns; i++) {
+				glBindBuffer(GL_ARRAY_BUFFER, plot->streamVBOs[slot][i]);
+				if (mapped[i])
+					glUnmapBuffer(GL_ARRAY_BUFFER);
+				else
+					free(dst[i]);
+			}
+			break;
+		}
+
+		// this chunk of each column, so offsets within it fit in an int
+		QDSParray cols[3];
+		for (int i = 0; i < numColumns; i++) {
+			cols[i] = plot->streamColumns[i];
+			cols[i].data = (const char*)cols[i].data + start * cols[i].stride;
+		}
+		int numSub = (len + UPLOAD_CHUNK - 1) / UPLOAD_CHUNK;
+		int stream = (sizes[0] + sizes[1] + (hasColor ? sizes[2] : 0) >= QDSP_STREAM_MIN);
+
+#pragma omp parallel
+		{
+			double *myX = isPacked(&cols[0], QDSP_FLOAT64) ? NULL : malloc(UPLOAD_CHUNK * sizeof(double));
+			double *myY = isPacked(&cols[1], QDSP_FLOAT64) ? NULL : malloc(UPLOAD_CHUNK * sizeof(double));
+			int *myColor = (!hasColor || isPacked(&cols[2], QDSP_INT32))
+				? NULL : malloc(UPLOAD_CHUNK * sizeof(int));
+
+#pragma omp for schedule(static)
+			for (int c = 0; c < numSub; c++) {
+				int sub = c * UPLOAD_CHUNK;
+				int subLen = (len - sub < UPLOAD_CHUNK) ? len - sub : UPLOAD_CHUNK;
+				kernels->convert((float*)dst[0] + sub, chunkDoubles(&cols[0], sub, subLen, myX),
+				                 subLen, plot->xOrigin, stream);
+				kernels->convert((float*)dst[1] + sub, chunkDoubles(&cols[1], sub, subLen, myY),
+				                 subLen, plot->yOrigin, stream);
+				if (hasColor)
+					kernels->packColor((int*)dst[2] + sub, chunkColors(&cols[2], sub, subLen, myColor),
+					                   subLen, stream);
+			}
+
+			free(myX);
+			free(myY);
+			free(myColor);
+		}
+
+		// a buffer that fails to unmap is garbage, but only for this frame
+		for (int i = 0; i < numColumns; i++) {
+			glBindBuffer(GL_ARRAY_BUFFER, plot->streamVBOs[slot][i]);
+			if (mapped[i]) {
+				glUnmapBuffer(GL_ARRAY_BUFFER);
+			} else {
+				glBufferSubData(GL_ARRAY_BUFFER, 0, sizes[i], dst[i]);
+				free(dst[i]);
+			}
+		}
+
+		glBindVertexArray(plot->streamVAOs[slot]);
+		glDrawArrays(GL_POINTS, 0, len);
+		plot->streamFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		// the chunk won't be read again this pass, so its pages can go
+		adviseRows(plot, start, len, MADV_DONTNEED);
+
+		long long bytes = len * (2 * sizeof(float) + (hasColor ? sizeof(int) : 0));
+		plot->statsPoints += len;
+		plot->statsBytes += bytes;
+		plot->stats.pointsUploaded += len;
+		plot->stats.bytesUploaded += bytes;
+	}
+
+	glUseProgram(plot->pointsProgram);
+	glUniform1i(glGetUniformLocation(plot->pointsProgram, "numFiltered"), plot->numFiltered);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(plot->panelX, plot->panelY, plot->width, plot->height);
+	glEnable(GL_SCISSOR_TEST);
+}
+
+// advises the kernel about rows of the mapped file; only whole pages inside
+// the rows are dropped, but pages touching them are read ahead
+static void adviseRows(QDSPplot *plot, long long start, long long len, int advice) {
+	uintptr_t page = sysconf(_SC_PAGESIZE);
+	uintptr_t mapEnd = (uintptr_t)plot->streamMap + plot->streamSize;
+
+	if (start + len > plot->streamPoints)
+		len = plot->streamPoints - start;
+
+	for (int i = 0; i < (plot->streamHasColor ? 3 : 2); i++) {
+		const QDSParray *col = &plot->streamColumns[i];
+		uintptr_t lo = (uintptr_t)col->data + start * col->stride;
+		uintptr_t hi = lo + len * col->stride;
+
+		if (advice == MADV_DONTNEED) {
+			lo = (lo + page - 1) & ~(page - 1);
+			hi &= ~(page - 1);
+		} else {
+			lo &= ~(page - 1);
+			hi = (hi + page - 1) & ~(page - 1);
+		}
+		if (hi > mapEnd)
+			hi = (mapEnd + page - 1) & ~(page - 1);
+
+		if (hi > lo)
+			madvise((void*)lo, hi - lo, advice);
+	}
+}
+
+// builds the table of curves for the lines program and uploads it, returning
+// its size in bytes; curves too short to have a segment are dropped, so starts
+// are strictly increasing
+static int uploadCurves(QDSPplot *plot, int *starts, int *counts, int *colors, int numCurves) {
+	if (numCurves > plot->curveCapacity) {
+		plot->curveCapacity = numCurves;
+		plot->curveTable = realloc(plot->curveTable, 4 * numCurves * sizeof(int));
+		plot->curveFirst = realloc(plot->curveFirst, numCurves * sizeof(int));
+		plot->curveCount = realloc(plot->curveCount, numCurves * sizeof(int));
+	}
+
+	int n = 0;
+	for (int i = 0; i < numCurves; i++) {
+		if (counts[i] < 2)
+			continue;
+
+		plot->curveTable[4*n + 0] = starts[i];
+		plot->curveTable[4*n + 1] = counts[i];
+		plot->curveTable[4*n + 2] = colors ? colors[i] : 0;
+		plot->curveTable[4*n + 3] = 0;
+		plot->curveFirst[n] = starts[i];
+		plot->curveCount[n] = counts[i];
+		n++;
+	}
+	plot->numCurves = n;
+
+	glBindBuffer(GL_ARRAY_BUFFER, plot->curvesVBO);
+	glBufferData(GL_ARRAY_BUFFER, 4 * n * sizeof(int), plot->curveTable, GL_STREAM_DRAW);
+
+	glUseProgram(plot->linesProgram);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "numCurves"), n);
+	glUniform1i(glGetUniformLocation(plot->linesProgram, "useCurveColor"), colors != NULL);
+
+	return 4 * n * sizeof(int);
+}
+
+// buffers and a vertex array for a new segment, in the current position format
+static void initSegment(QDSPplot *plot, struct QDSPsegment *seg) {
+	GLenum type = plot->highPrecision ? GL_FLOAT : GL_DOUBLE;
+	GLenum format = plot->highPrecision ? GL_R32UI : GL_RG32UI;
+
+	glGenVertexArrays(1, &seg->vao);
+	glGenBuffers(3, seg->vbos);
+	glGenTextures(2, seg->textures);
+	glBindVertexArray(seg->vao);
+
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_ARRAY_BUFFER, seg->vbos[i]);
+		glVertexAttribPointer(i, 1, type, GL_FALSE, 0, NULL);
+		glEnableVertexAttribArray(i);
+
+		glBindTexture(GL_TEXTURE_BUFFER, seg->textures[i]);
+		glTexBuffer(GL_TEXTURE_BUFFER, format, seg->vbos[i]);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, seg->vbos[2]);
+	glVertexAttribIPointer(2, 1, GL_INT, 0, NULL);
+	glEnableVertexAttribArray(2);
+}
+
+// splits numPoints points into segments, making any new ones, and returns 0 if
+// they couldn't be made
+static int splitPoints(QDSPplot *plot, size_t numPoints) {
+	size_t step = plot->segmentPoints - plot->segmentOverlap;
+	int needed = 1;
+	if (numPoints > plot->segmentPoints)
+		needed = (numPoints - plot->segmentOverlap + step - 1) / step;
+
+	if (needed > plot->segmentCapacity) {
+		struct QDSPsegment *segments = realloc(plot->segments, needed * sizeof(struct QDSPsegment));
+		if (segments == NULL) {
+			fprintf(stderr, "Couldn't allocate point buffers\n");
+			return 0;
+		}
+		plot->segments = segments;
+		for (int k = plot->segmentCapacity; k < needed; k++)
+			initSegment(plot, &segments[k]);
+		plot->segmentCapacity = needed;
+	}
+
+	// segments that aren't needed any more give their memory back
+	for (int k = needed; k < plot->numSegments; k++) {
+		for (int i = 0; i < 3; i++) {
+			glBindBuffer(GL_ARRAY_BUFFER, plot->segments[k].vbos[i]);
+			glBufferData(GL_ARRAY_BUFFER, 0, NULL, GL_STREAM_DRAW);
+		}
+	}
+
+	plot->numSegments = needed;
+	plot->numPoints = numPoints;
+	return 1;
+}
+
+// the first point in segment k
+static size_t segmentBase(QDSPplot *plot, int k) {
+	return k * (plot->segmentPoints - plot->segmentOverlap);
+}
+
+static size_t segmentSize(QDSPplot *plot, int k) {
+	size_t left = plot->numPoints - segmentBase(plot, k);
+	return (left < plot->segmentPoints) ? left : plot->segmentPoints;
+}
+
+// the first point in segment k, for the shaders' base uniform, or -1 if the
+// application's indices of its points don't fit in an int
+static int segmentIndex(QDSPplot *plot, int k) {
+	size_t end = (segmentBase(plot, k) + segmentSize(plot, k)) * plot->uploadStride;
+	return (end <= INT_MAX) ? (int)segmentBase(plot, k) : -1;
+}
+
+// copies x, y, and color into the segments' buffers, with positions as
+// offsets from the origin in high precision mode, finding the data range along
+// the way if we need it; with an order, the points are taken in that order
+static void uploadPoints(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                         const QDSParray *color, size_t numPoints, const unsigned int *order) {
+	const QDSPkernels *kernels = qdspKernels();
+	int precise = plot->highPrecision;
+	size_t coordSize = precise ? sizeof(float) : sizeof(double);
+	int numSegments = plot->numSegments;
+
+	if (precise)
+		recenter(plot);
+
+	// every segment is mapped at once; colors are optional, so they're
+	// copied in the same pass only if present. If mapping fails, fill scratch
+	// memory and copy it over afterwards
+	void *(*dst)[3] = malloc(numSegments * sizeof(*dst));
+	int (*mapped)[3] = malloc(numSegments * sizeof(*mapped));
+	if (dst == NULL || mapped == NULL) {
+		fprintf(stderr, "Couldn't allocate point buffers\n");
+		free(dst);
+		free(mapped);
+		return;
+	}
+	int numArrays = color ? 3 : 2;
+	for (int k = 0; k < numSegments; k++) {
+		size_t count = segmentSize(plot, k);
+		size_t sizes[] = {count * coordSize, count * coordSize, count * sizeof(int)};
+		for (int i = 0; i < 3; i++) {
+			glBindBuffer(GL_ARRAY_BUFFER, plot->segments[k].vbos[i]);
+			glBufferData(GL_ARRAY_BUFFER, sizes[i], NULL, GL_STREAM_DRAW);
+			dst[k][i] = NULL;
+			mapped[k][i] = 0;
+			if (i < numArrays) {
+				dst[k][i] = glMapBufferRange(GL_ARRAY_BUFFER, 0, sizes[i],
+				                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+				if (!(mapped[k][i] = (dst[k][i] != NULL)))
+					dst[k][i] = malloc(sizes[i]);
+			}
+		}
+	}
+
+	int findRange = (plot->autoBounds != QDSP_AUTO_OFF);
+	double xMin = INFINITY, xMax = -INFINITY;
+	double yMin = INFINITY, yMax = -INFINITY;
+
+	// histograms span a window around last frame's percentiles, anything
+	// outside goes in the end bins
+	int percentile = (plot->autoBounds == QDSP_AUTO_PERCENTILE
+	                  && plot->autoRange[1] > plot->autoRange[0]
+	                  && plot->autoRange[3] > plot->autoRange[2]);
+	double xLo = plot->autoRange[0], yLo = plot->autoRange[2];
+	double xScale = AUTO_BINS / (plot->autoRange[1] - plot->autoRange[0]);
+	double yScale = AUTO_BINS / (plot->autoRange[3] - plot->autoRange[2]);
+	long long *xHist = calloc(AUTO_BINS, sizeof(long long));
+	long long *yHist = calloc(AUTO_BINS, sizeof(long long));
+
+	// work in cache-sized chunks, so the range and histogram passes read the
+	// data from memory once and the copy gets it from cache
+	ptrdiff_t numChunks = (numPoints + UPLOAD_CHUNK - 1) / UPLOAD_CHUNK;
+
+	// the buffers only skip the cache when they wouldn't fit in it anyway
+	size_t bytes = numPoints * (2 * coordSize + (color ? sizeof(int) : 0));
+	int stream = (bytes >= QDSP_STREAM_MIN);
+
+#pragma omp parallel
+	{
+		double myXMin = INFINITY, myXMax = -INFINITY;
+		double myYMin = INFINITY, myYMax = -INFINITY;
+		long long *myXHist = percentile ? calloc(AUTO_BINS, sizeof(long long)) : NULL;
+		long long *myYHist = percentile ? calloc(AUTO_BINS, sizeof(long long)) : NULL;
+
+		// anything but packed doubles in order is gathered a chunk at a
+		// time, so the caller's arrays never need a full copy
+		int gather = (order != NULL);
+		double *myX = (isPacked(x, QDSP_FLOAT64) && !gather) ? NULL : malloc(UPLOAD_CHUNK * sizeof(double));
+		double *myY = (isPacked(y, QDSP_FLOAT64) && !gather) ? NULL : malloc(UPLOAD_CHUNK * sizeof(double));
+		int *myColor = (color == NULL || (isPacked(color, QDSP_INT32) && !gather))
+			? NULL : malloc(UPLOAD_CHUNK * sizeof(int));
+
+#pragma omp for schedule(static)
+		for (ptrdiff_t c = 0; c < numChunks; c++) {
+			size_t start = c * UPLOAD_CHUNK;
+			int len = (numPoints - start < UPLOAD_CHUNK) ? numPoints - start : UPLOAD_CHUNK;
+			const double *xSrc, *ySrc;
+			const int *colorSrc = NULL;
+			if (gather) {
+				gatherDoubles(x, order + start, len, myX);
+				gatherDoubles(y, order + start, len, myY);
+				if (color != NULL)
+					gatherColors(color, order + start, len, myColor);
+				xSrc = myX;
+				ySrc = myY;
+				colorSrc = myColor;
+			} else {
+				xSrc = chunkDoubles(x, start, len, myX);
+				ySrc = chunkDoubles(y, start, len, myY);
+				if (color != NULL)
+					colorSrc = chunkColors(color, start, len, myColor);
+			}
+
+			if (findRange) {
+				kernels->range(xSrc, len, &myXMin, &myXMax);
+				kernels->range(ySrc, len, &myYMin, &myYMax);
+			}
+
+			if (percentile) {
+				chunkHistogram(xSrc, len, xLo, xScale, myXHist);
+				chunkHistogram(ySrc, len, yLo, yScale, myYHist);
+			}
+
+			storeRun(plot, dst, start, len, xSrc, ySrc, colorSrc, stream);
+		}
+
+#pragma omp critical
+		{
+			xMin = fmin(xMin, myXMin);
+			xMax = fmax(xMax, myXMax);
+			yMin = fmin(yMin, myYMin);
+			yMax = fmax(yMax, myYMax);
+
+			if (percentile) {
+				for (int j = 0; j < AUTO_BINS; j++) {
+					xHist[j] += myXHist[j];
+					yHist[j] += myYHist[j];
+				}
+			}
+		}
+		free(myXHist);
+		free(myYHist);
+		free(myX);
+		free(myY);
+		free(myColor);
+	}
+
+	// if unmapping fails the buffer is garbage; packed doubles and colors in
+	// order can be recopied, but anything else will have to wait for the next
+	// update
+	const QDSParray *arrays[] = {x, y, color};
+	for (int k = 0; k < numSegments; k++) {
+		size_t first = segmentBase(plot, k);
+		size_t count = segmentSize(plot, k);
+		for (int i = 0; i < numArrays; i++) {
+			size_t size = count * (i < 2 ? coordSize : sizeof(int));
+			int packed = (i < 2) ? !precise && isPacked(arrays[i], QDSP_FLOAT64)
+			                     : isPacked(color, QDSP_INT32);
+			packed = packed && order == NULL;
+
+			glBindBuffer(GL_ARRAY_BUFFER, plot->segments[k].vbos[i]);
+			if (!mapped[k][i]) {
+				glBufferData(GL_ARRAY_BUFFER, size, dst[k][i], GL_STREAM_DRAW);
+				free(dst[k][i]);
+			} else if (!glUnmapBuffer(GL_ARRAY_BUFFER) && packed) {
+				glBufferData(GL_ARRAY_BUFFER, size,
+				             (const char*)arrays[i]->data + first * arrays[i]->stride,
+				             GL_STREAM_DRAW);
+			}
+		}
+	}
+	free(dst);
+	free(mapped);
+
+	// nothing (finite) to fit to
+	if (!findRange || !(xMin <= xMax && yMin <= yMax)
+	    || !isfinite(xMax - xMin) || !isfinite(yMax - yMin)) {
+		free(xHist);
+		free(yHist);
+		return;
+	}
+
+	double range[4] = {xMin, xMax, yMin, yMax};
+	double prev[4];
+	memcpy(prev, plot->autoRange, sizeof(prev));
+	memcpy(plot->autoRange, range, sizeof(range));
+
+	if (percentile) {
+		percentileRange(xHist, numPoints, prev[0], prev[1], &range[0], &range[1]);
+		percentileRange(yHist, numPoints, prev[2], prev[3], &range[2], &range[3]);
+		// the ends of the histogram hold everything outside last frame's range
+		range[0] = fmax(range[0], xMin);
+		range[1] = fmin(range[1], xMax);
+		range[2] = fmax(range[2], yMin);
+		range[3] = fmin(range[3], yMax);
+
+		// next frame's histograms zoom in on the percentiles, with some slack
+		// so the window can follow the data outwards
+		for (int a = 0; a < 4; a += 2) {
+			double slack = AUTO_PAD * (range[a+1] - range[a]);
+			plot->autoRange[a] = range[a] - slack;
+			plot->autoRange[a+1] = range[a+1] + slack;
+		}
+	}
+
+	free(xHist);
+	free(yHist);
+
+	fitBounds(plot, range);
+}
+
+// copies a run of points into the segments holding them, as float offsets in
+// high precision mode; the first point of each segment after the first is
+// also the last point of the one before if they overlap
+static void storeRun(QDSPplot *plot, void *(*dst)[3], size_t first, int len,
+                     const double *x, const double *y, const int *color, int stream) {
+	size_t step = plot->segmentPoints - plot->segmentOverlap;
+
+	while (len > 0) {
+		// the last segment can run a point past its step; the others stop
+		// short of the point they share, which is stored below
+		int k = first / step;
+		if (k >= plot->numSegments)
+			k = plot->numSegments - 1;
+		size_t offset = first - segmentBase(plot, k);
+		size_t end = (k == plot->numSegments - 1) ? segmentSize(plot, k) : step;
+		int n = (end - offset < (size_t)len) ? (int)(end - offset) : len;
+
+		storePoints(plot, dst[k], offset, x, y, color, n, stream);
+		if (plot->segmentOverlap && offset == 0 && k > 0)
+			storePoints(plot, dst[k - 1], step, x, y, color, 1, stream);
+
+		first += n;
+		x += n;
+		y += n;
+		if (color != NULL)
+			color += n;
+		len -= n;
+	}
+}
+
+static void storePoints(QDSPplot *plot, void **dst, size_t offset, const double *x,
+                        const double *y, const int *color, int len, int stream) {
+	const QDSPkernels *kernels = qdspKernels();
+	if (plot->highPrecision) {
+		kernels->convert((float*)dst[0] + offset, x, len, plot->xOrigin, stream);
+		kernels->convert((float*)dst[1] + offset, y, len, plot->yOrigin, stream);
+	} else {
+		kernels->copy64((double*)dst[0] + offset, x, len, stream);
+		kernels->copy64((double*)dst[1] + offset, y, len, stream);
+	}
+
+	if (color != NULL)
+		kernels->packColor((int*)dst[2] + offset, color, len, stream);
+}
+
+// one chunk of an array as packed doubles, straight from the array if it's
+// already packed, or gathered into scratch
+static const double *chunkDoubles(const QDSParray *arr, ptrdiff_t start, int len, double *scratch) {
+	const char *src = (const char*)arr->data + start * arr->stride;
+	if (scratch == NULL)
+		return (const double*)src;
+
+	if (arr->type == QDSP_FLOAT32) {
+		for (int i = 0; i < len; i++)
+			scratch[i] = *(const float*)(src + i * arr->stride);
+	} else {
+		for (int i = 0; i < len; i++)
+			scratch[i] = *(const double*)(src + i * arr->stride);
+	}
+	return scratch;
+}
+
+static const int *chunkColors(const QDSParray *arr, ptrdiff_t start, int len, int *scratch) {
+	const char *src = (const char*)arr->data + start * arr->stride;
+	if (scratch == NULL)
+		return (const int*)src;
+
+	for (int i = 0; i < len; i++)
+		scratch[i] = *(const int*)(src + i * arr->stride);
+	return scratch;
+}
+
+// like chunkDoubles, for the points at the given indices
+static void gatherDoubles(const QDSParray *arr, const unsigned int *order, int len, double *dst) {
+	const char *src = arr->data;
+	if (arr->type == QDSP_FLOAT32) {
+		for (int i = 0; i < len; i++)
+			dst[i] = *(const float*)(src + order[i] * arr->stride);
+	} else {
+		for (int i = 0; i < len; i++)
+			dst[i] = *(const double*)(src + order[i] * arr->stride);
+	}
+}
+
+static void gatherColors(const QDSParray *arr, const unsigned int *order, int len, int *dst) {
+	const char *src = arr->data;
+	for (int i = 0; i < len; i++)
+		dst[i] = *(const int*)(src + order[i] * arr->stride);
+}
+
+// orders the points by the Morton code of the screen tile they fall in, so
+// points drawn one after another land near each other; last frame's order is
+// kept while it's still nearly sorted. Returns NULL if there's no memory to
+// sort with.
+static const unsigned int *sortPoints(QDSPplot *plot, const QDSParray *x, const QDSParray *y,
+                                      size_t numPoints) {
+	if (numPoints > plot->sortCapacity) {
+		free(plot->sortKeys);
+		free(plot->sortOrder);
+		plot->sortKeys = malloc(numPoints * sizeof(unsigned int));
+		plot->sortOrder = malloc(numPoints * sizeof(unsigned int));
+		plot->sortCapacity = numPoints;
+		plot->sortValid = 0;
+		if (plot->sortKeys == NULL || plot->sortOrder == NULL) {
+			fprintf(stderr, "Couldn't allocate memory to sort points\n");
+			free(plot->sortKeys);
+			free(plot->sortOrder);
+			plot->sortKeys = NULL;
+			plot->sortOrder = NULL;
+			plot->sortCapacity = 0;
+			return NULL;
+		}
+	}
+	unsigned int *keys = plot->sortKeys, *order = plot->sortOrder;
+	int valid = plot->sortValid && plot->sortCount == numPoints;
+
+	// tiles are over the current view, anything outside it goes in the
+	// edge tiles
+	int xTiles = (plot->width + SORT_TILE - 1) / SORT_TILE;
+	int yTiles = (plot->height + SORT_TILE - 1) / SORT_TILE;
+	xTiles = (xTiles < 1) ? 1 : (xTiles > (1 << SORT_BITS)) ? (1 << SORT_BITS) : xTiles;
+	yTiles = (yTiles < 1) ? 1 : (yTiles > (1 << SORT_BITS)) ? (1 << SORT_BITS) : yTiles;
+	double xMin = plot->xMin, xScale = xTiles / (plot->xMax - plot->xMin);
+	double yMin = plot->yMin, yScale = yTiles / (plot->yMax - plot->yMin);
+
+	ptrdiff_t numChunks = (numPoints + UPLOAD_CHUNK - 1) / UPLOAD_CHUNK;
+	size_t descents = 0;
+
+#pragma omp parallel
+	{
+		double *myX = isPacked(x, QDSP_FLOAT64) ? NULL : malloc(UPLOAD_CHUNK * sizeof(double));
+		double *myY = isPacked(y, QDSP_FLOAT64) ? NULL : malloc(UPLOAD_CHUNK * sizeof(double));
+
+#pragma omp for schedule(static)
+		for (ptrdiff_t c = 0; c < numChunks; c++) {
+			size_t start = c * UPLOAD_CHUNK;
+			int len = (numPoints - start < UPLOAD_CHUNK) ? numPoints - start : UPLOAD_CHUNK;
+			const double *xSrc = chunkDoubles(x, start, len, myX);
+			const double *ySrc = chunkDoubles(y, start, len, myY);
+			for (int i = 0; i < len; i++) {
+				unsigned int tx = fmin(fmax((xSrc[i] - xMin) * xScale, 0), xTiles - 1);
+				unsigned int ty = fmin(fmax((ySrc[i] - yMin) * yScale, 0), yTiles - 1);
+				keys[start + i] = spreadBits(tx) | (spreadBits(ty) << 1);
+			}
+		}
+
+		// particles move a little each step, so last frame's order is
+		// usually close
+		if (valid) {
+#pragma omp for schedule(static) reduction(+:descents)
+			for (size_t i = 1; i < numPoints; i++)
+				descents += keys[order[i]] < keys[order[i - 1]];
+		}
+
+		free(myX);
+		free(myY);
+	}
+
+	if (valid && descents <= SORT_SLACK * numPoints)
+		return order;
+
+	// two radix passes, through scratch and back
+	unsigned int *scratch = malloc(2 * numPoints * sizeof(unsigned int));
+	size_t *counts = malloc((size_t)omp_get_max_threads() * (1 << SORT_BITS) * sizeof(size_t));
+	if (scratch == NULL || counts == NULL) {
+		fprintf(stderr, "Couldn't allocate memory to sort points\n");
+		free(scratch);
+		free(counts);
+		plot->sortValid = 0;
+		return NULL;
+	}
+
+#pragma omp parallel for schedule(static)
+	for (size_t i = 0; i < numPoints; i++)
+		order[i] = i;
+
+	radixPass(keys, order, scratch, scratch + numPoints, numPoints, 0, counts);
+	radixPass(scratch, scratch + numPoints, keys, order, numPoints, SORT_BITS, counts);
+
+	free(scratch);
+	free(counts);
+
+	plot->sortValid = 1;
+	plot->sortCount = numPoints;
+	return order;
 }
 
-void qdspSetBounds(QDSPplot *plot, double xMin, double xMax, double yMin, double yMax) {
-	glfwMakeContextCurrent(plot->window);
-	
-	glUseProgram(plot->pointsProgram);
-	glUniform1f(glGetUniformLocation(plot->pointsProgram, "xMin"), xMin);
-	glUniform1f(glGetUniformLocation(plot->pointsProgram, "xMax"), xMax);
-	glUniform1f(glGetUniformLocation(plot->pointsProgram, "yMin"), yMin);
-	glUniform1f(glGetUniformLocation(plot->pointsProgram, "yMax"), yMax);
-	plot->xMin = xMin;
-	plot->xMax = xMax;
-	plot->yMin = yMin;
-	plot->yMax = yMax;
+// a selection made on sorted points holds their places on the GPU, so when
+// they go back to the application's order, it's turned into the application's
+// indices; sorting stops while there's a selection, so this only happens once
+static void unsortSelection(QDSPplot *plot, int stride) {
+	// one still being found was found on the sorted points too
+	if (plot->selectFence != NULL)
+		readSelection(plot);
+	if (plot->numSelected == 0)
+		return;
+
+	int count = plot->numSelected;
+	int *indices = malloc(count * sizeof(int));
+	if (indices == NULL) {
+		fprintf(stderr, "Couldn't keep the selection\n");
+		plot->numSelected = 0;
+		return;
+	}
 
-	// if no grid has been set, we need to make sure it doesn't look like crap
-	if (plot->xAutoGrid)
-		qdspSetGridX(plot, xMin, (xMax - xMin) / 4, 0x000000);
+	glBindBuffer(GL_COPY_READ_BUFFER, plot->selectVBO);
+	glGetBufferSubData(GL_COPY_READ_BUFFER, 0, count * sizeof(int), indices);
+	for (int i = 0; i < count; i++) {
+		size_t place = indices[i] / stride;
+		if (place < plot->sortCount)
+			indices[i] = plot->sortOrder[place] * stride;
+	}
+	glBufferSubData(GL_COPY_READ_BUFFER, 0, count * sizeof(int), indices);
+	free(indices);
+}
 
-	if (plot->yAutoGrid)
-		qdspSetGridY(plot, yMin, (yMax - yMin) / 4, 0x000000);
+// one stable pass of a parallel LSD radix sort on SORT_BITS bits of the keys;
+// each thread counts its own share of the points, then scatters them to its
+// own slots in each bucket
+static void radixPass(const unsigned int *keys, const unsigned int *order, unsigned int *keysOut,
+                      unsigned int *orderOut, size_t n, int shift, size_t *counts) {
+	const unsigned int mask = (1u << SORT_BITS) - 1;
+
+#pragma omp parallel
+	{
+		int numThreads = omp_get_num_threads(), t = omp_get_thread_num();
+		size_t lo = n * t / numThreads, hi = n * (t + 1) / numThreads;
+		size_t *mine = counts + (size_t)t * (mask + 1);
+
+		memset(mine, 0, (mask + 1) * sizeof(size_t));
+		for (size_t i = lo; i < hi; i++)
+			mine[(keys[i] >> shift) & mask]++;
+
+#pragma omp barrier
+#pragma omp single
+		{
+			// bucket by bucket, then thread by thread, keeps the pass stable
+			size_t sum = 0;
+			for (unsigned int b = 0; b <= mask; b++) {
+				for (int j = 0; j < numThreads; j++) {
+					size_t count = counts[(size_t)j * (mask + 1) + b];
+					counts[(size_t)j * (mask + 1) + b] = sum;
+					sum += count;
+				}
+			}
+		}
+
+		for (size_t i = lo; i < hi; i++) {
+			size_t slot = mine[(keys[i] >> shift) & mask]++;
+			keysOut[slot] = keys[i];
+			orderOut[slot] = order[i];
+		}
+	}
 }
 
-void qdspSetConnected(QDSPplot *plot, int connected) {
-	plot->connected = connected;
+// spreads the low 16 bits of v out to the even bits, for Morton codes
+static unsigned int spreadBits(unsigned int v) {
+	v &= 0xffff;
+	v = (v | (v << 8)) & 0x00ff00ff;
+	v = (v | (v << 4)) & 0x0f0f0f0f;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
 }
 
-void qdspSetPointSize(QDSPplot *plot, int pixels) {
-	glfwMakeContextCurrent(plot->window);
-	
-	glUseProgram(plot->pointsProgram);
-	glUniform1i(glGetUniformLocation(plot->pointsProgram, "pointSize"), pixels);
+static void chunkHistogram(const double *src, int len, double lo, double scale, long long *hist) {
+	for (int i = 0; i < len; i++) {
+		int bin = (int)fmin(fmax((src[i] - lo) * scale, 0), AUTO_BINS - 1);
+		hist[bin]++;
+	}
 }
 
-void qdspSetPointAlpha(QDSPplot *plot, double alpha) {
-	glfwMakeContextCurrent(plot->window);
-	
-	glUseProgram(plot->pointsProgram);
-	glUniform1f(glGetUniformLocation(plot->pointsProgram, "alpha"), alpha);
+// moves the origin to the middle of the view once the view is far enough away
+// that float offsets would lose precision
+static void recenter(QDSPplot *plot) {
+	double xCenter = 0.5 * (plot->xMin + plot->xMax);
+	double yCenter = 0.5 * (plot->yMin + plot->yMax);
+	int moved = 0;
+
+	if (fabs(xCenter - plot->xOrigin) > RECENTER_SPANS * (plot->xMax - plot->xMin)) {
+		plot->xOrigin = xCenter;
+		moved = 1;
+	}
+
+	if (fabs(yCenter - plot->yOrigin) > RECENTER_SPANS * (plot->yMax - plot->yMin)) {
+		plot->yOrigin = yCenter;
+		moved = 1;
+	}
+
+	if (moved) {
+		setViewUniforms(plot);
+		setFilterUniforms(plot);
+		// trail positions are relative to the old origin
+		plot->trailFilled = 0;
+	}
 }
 
-void qdspSetPointColor(QDSPplot *plot, int rgb) {
-	glfwMakeContextCurrent(plot->window);
-	
-	glUseProgram(plot->pointsProgram);
-	glUniform1i(glGetUniformLocation(plot->pointsProgram, "defaultColor"), rgb);
+// finds the interval holding all but AUTO_PERCENTILE of the data at each end
+static void percentileRange(const long long *hist, size_t count, double lo, double hi,
+                            double *pLo, double *pHi) {
+	double binWidth = (hi - lo) / AUTO_BINS;
+	long long cut = (long long)(AUTO_PERCENTILE * count);
+
+	long long sum = 0;
+	int j;
+	for (j = 0; j < AUTO_BINS - 1 && sum + hist[j] <= cut; j++)
+		sum += hist[j];
+	*pLo = lo + j * binWidth;
+
+	sum = 0;
+	for (j = AUTO_BINS - 1; j > 0 && sum + hist[j] <= cut; j--)
+		sum += hist[j];
+	*pHi = lo + (j + 1) * binWidth;
 }
 
-void qdspSetBGColor(QDSPplot *plot, int rgb) {
-	glfwMakeContextCurrent(plot->window);
+// moves the bounds to fit range (xMin, xMax, yMin, yMax) according to the mode
+static void fitBounds(QDSPplot *plot, const double *range) {
+	double cur[4] = {plot->homeXMin, plot->homeXMax, plot->homeYMin, plot->homeYMax};
+	double fit[4];
+	int changed = 0;
+
+	for (int a = 0; a < 4; a += 2) {
+		double lo = range[a], hi = range[a+1];
+
+		// a single value still needs some room around it
+		if (!(hi > lo)) {
+			double half = (lo != 0) ? 0.5 * fabs(lo) : 1.0;
+			lo -= half;
+			hi += half;
+		}
+
+		if (plot->autoBounds == QDSP_AUTO_PADDED || plot->autoBounds == QDSP_AUTO_EXPAND) {
+			double pad = AUTO_PAD * (hi - lo);
+			lo -= pad;
+			hi += pad;
+		}
+
+		double curSpan = cur[a+1] - cur[a];
+
+		if (plot->autoBounds == QDSP_AUTO_EXPAND) {
+			// grow right away, shrink only once the data is well inside
+			int outside = range[a] < cur[a] || range[a+1] > cur[a+1];
+			int small = (range[a+1] - range[a]) < AUTO_SHRINK * curSpan;
+			if (outside && !small) {
+				lo = fmin(lo, cur[a]);
+				hi = fmax(hi, cur[a+1]);
+			} else if (!small) {
+				lo = cur[a];
+				hi = cur[a+1];
+			}
+			fit[a] = lo;
+			fit[a+1] = hi;
+			changed |= (lo != cur[a] || hi != cur[a+1]);
+		} else {
+			// ignore small changes so the view doesn't jitter
+			fit[a] = lo;
+			fit[a+1] = hi;
+			changed |= !(fabs(lo - cur[a]) <= AUTO_DEADBAND * curSpan
+			             && fabs(hi - cur[a+1]) <= AUTO_DEADBAND * curSpan);
+		}
+	}
 
-	glClearColor((0xff & rgb >> 16) / 255.0,
-	             (0xff & rgb >> 8) / 255.0,
-	             (0xff & rgb) / 255.0,
-	             1.0f);
+	if (changed)
+		qdspSetBounds(plot, fit[0], fit[1], fit[2], fit[3]);
 }
 
-void qdspSetGridX(QDSPplot *plot, double point, double interval, int rgb) {
-	glfwMakeContextCurrent(plot->window);
-	
-	if (interval <= 0) return;
+static void glyphHelper(struct QDSPglyph *glyph, float x, float y, int col, int row, char ch) {
+	// anything we don't have in the atlas shows up as '?'
+	if (ch < ATLAS_FIRST || ch >= ATLAS_FIRST + ATLAS_CHARS)
+		ch = '?';
 
-	plot->xAutoGrid = 0;
-	
-	int iMin = (int)ceil((plot->xMin - point) / interval);
-	int iMax = (int)floor((plot->xMax - point) / interval);
-	int numLines = (iMax - iMin + 1);
-	plot->numGridX = numLines;
-	
-	float *coords = malloc(4 * numLines * sizeof(float));
+	glyph->x = x;
+	glyph->y = y;
+	glyph->col = col;
+	glyph->row = row;
+	glyph->ch = ch - ATLAS_FIRST;
+}
 
-	// 10 chars/label, 36 floats/char
-	float *labels = malloc(10 * 36 * numLines * sizeof(float));
+// gathers all visible text into the instance buffer, in draw order
+static void updateText(QDSPplot *plot) {
+	int count = 0;
+	if (plot->grid)
+		count += plot->numGridGlyphs[0] + plot->numGridGlyphs[1];
+	if (plot->hud)
+		count += HUD_CHARS * HUD_ROWS;
+	for (int i = 0; i < QDSP_MAX_TEXT; i++)
+		if (plot->text[i] != NULL)
+			count += strlen(plot->text[i]);
+
+	if (count > plot->glyphCapacity) {
+		plot->glyphCapacity = 2 * count;
+		plot->glyphs = realloc(plot->glyphs, plot->glyphCapacity * sizeof(struct QDSPglyph));
+	}
 
-	for (int i = 0; i < numLines; i++) {
-		double x = point + (iMin + i) * interval;
-		double xNorm = 2 * (x - plot->xMin) / (plot->xMax - plot->xMin) - 1;
-		coords[4*i + 0] = xNorm;
-		coords[4*i + 1] = -1;
-		coords[4*i + 2] = xNorm;
-		coords[4*i + 3] = 1;
-
-		char str[11];
-		snprintf(str, 11, "% .3e", x);
-		
-		int off = (i == 0); // to prevent overlap, offset bottom left by 1
-		for (int j = 0; j < 10; j++)
-			charHelper(&labels[36*(10*i + j)], xNorm, -1, off + j, 0, str[j]);
+	int n = 0;
+	if (plot->grid) {
+		for (int i = 0; i < 2; i++) {
+			memcpy(&plot->glyphs[n], plot->gridGlyphs[i],
+			       plot->numGridGlyphs[i] * sizeof(struct QDSPglyph));
+			n += plot->numGridGlyphs[i];
+		}
 	}
 
-	glUseProgram(plot->gridProgram);
-	
-	// pass x,y
-	glBindVertexArray(plot->gridVAOx);
-	glBindBuffer(GL_ARRAY_BUFFER, plot->gridVBOx);
-	glBufferData(GL_ARRAY_BUFFER, 4 * numLines * sizeof(float), coords, GL_STATIC_DRAW);
-
-	// pass label data
-	glBindVertexArray(plot->textVAOx);
-	glBindBuffer(GL_ARRAY_BUFFER, plot->textVBOx);
-	glBufferData(GL_ARRAY_BUFFER, 10 * 36 * numLines * sizeof(float), labels, GL_STATIC_DRAW);
-	
-	// pass rgba
-	glUniform4f(glGetUniformLocation(plot->gridProgram, "xColor"),
-	            (0xff & rgb >> 16) / 255.0,
-	            (0xff & rgb >> 8) / 255.0,
-	            (0xff & rgb) / 255.0,
-	            1.0f);
-	
-	free(coords);
-	free(labels);
+	if (plot->hud) {
+		memcpy(&plot->glyphs[n], plot->hudGlyphs,
+		       HUD_CHARS * HUD_ROWS * sizeof(struct QDSPglyph));
+		n += HUD_CHARS * HUD_ROWS;
+	}
+
+	for (int i = 0; i < QDSP_MAX_TEXT; i++) {
+		const char *str = plot->text[i];
+		if (str == NULL)
+			continue;
+
+		float x = 2 * plot->textPos[i][0] - 1;
+		float y = 2 * plot->textPos[i][1] - 1;
+		int col = 0, row = 0;
+		for (; *str; str++) {
+			if (*str == '\n') {
+				col = 0;
+				row--;
+				continue;
+			}
+			glyphHelper(&plot->glyphs[n++], x, y, col++, row, *str);
+		}
+	}
+
+	plot->numGlyphs = n;
+	plot->textDirty = 0;
+
+	glBindBuffer(GL_ARRAY_BUFFER, plot->textVBO);
+	glBufferData(GL_ARRAY_BUFFER, n * sizeof(struct QDSPglyph), plot->glyphs, GL_STREAM_DRAW);
 }
 
-void qdspSetGridY(QDSPplot *plot, double point, double interval, int rgb) {
-	glfwMakeContextCurrent(plot->window);
-	
-	if (interval <= 0) return;
+static void updateStats(QDSPplot *plot) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	// time since the last redraw goes into the frame-time graph
+	plot->frameMs[plot->frameIdx] = msDiff(&plot->lastRedraw, &now);
+	plot->frameIdx = (plot->frameIdx + 1) % QDSP_HUD_SAMPLES;
+	plot->lastRedraw = now;
+	plot->statsFrames++;
+	plot->stats.frames++;
+
+	// collect GPU times from the queries we're about to reuse, if they're done
+	unsigned int *queries = plot->gpuQueries[plot->gpuQueryIdx];
+	if (plot->gpuQueryUsed[plot->gpuQueryIdx]) {
+		int available;
+		glGetQueryObjectiv(queries[2], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			for (int i = 0; i < 3; i++) {
+				GLuint64 ns;
+				glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+				plot->statsGpuMs[i] += ns * 1.0e-6;
+			}
+			plot->statsGpuFrames++;
+		}
+	}
 
-	plot->yAutoGrid = 0;
+	double windowMs = msDiff(&plot->statsStart, &now);
+	if (windowMs < STATS_INTERVAL)
+		return;
 
-	int iMin = (int)ceil((plot->yMin - point) / interval);
-	int iMax = (int)floor((plot->yMax - point) / interval);
-	int numLines = (iMax - iMin + 1);
-	plot->numGridY = numLines;
-	
-	float *coords = malloc(4 * numLines * sizeof(float));
-	// 10 chars/label, 36 floats/char
-	float *labels = malloc(10 * 36 * numLines * sizeof(float));
-	
-	for (int i = 0; i < numLines; i++) {
-		double y = point + (iMin + i) * interval;
-		double yNorm = 2 * (y - plot->yMin) / (plot->yMax - plot->yMin) - 1;
-		coords[4*i + 0] = -1;
-		coords[4*i + 1] = yNorm;
-		coords[4*i + 2] = 1;
-		coords[4*i + 3] = yNorm;
-
-		char str[11];
-		snprintf(str, 11, "% .3e", y);
-		
-		int off = (i == 0);
-		for (int j = 0; j < 10; j++)
-			charHelper(&labels[36*(10*i + j)], -1, yNorm, j, off, str[j]);
+	plot->stats.fps = 1000.0 * plot->statsFrames / windowMs;
+	plot->stats.frameMs = windowMs / plot->statsFrames;
+	plot->stats.pointsPerSec = 1000.0 * plot->statsPoints / windowMs;
+	plot->stats.bytesPerSec = 1000.0 * plot->statsBytes / windowMs;
+
+	if (plot->statsGpuFrames > 0) {
+		plot->stats.gpuGridMs = plot->statsGpuMs[0] / plot->statsGpuFrames;
+		plot->stats.gpuPointsMs = plot->statsGpuMs[1] / plot->statsGpuFrames;
+		plot->stats.gpuTextMs = plot->statsGpuMs[2] / plot->statsGpuFrames;
 	}
 
-	glUseProgram(plot->gridProgram);
-	
-	// pass x,y
-	glBindVertexArray(plot->gridVAOy);
-	glBindBuffer(GL_ARRAY_BUFFER, plot->gridVBOy);
-	glBufferData(GL_ARRAY_BUFFER, 4 * numLines * sizeof(float), coords, GL_STATIC_DRAW);
-
-	// pass label data
-	glBindVertexArray(plot->textVAOy);
-	glBindBuffer(GL_ARRAY_BUFFER, plot->textVBOy);
-	glBufferData(GL_ARRAY_BUFFER, 10 * 36 * numLines * sizeof(float), labels, GL_STATIC_DRAW);
-	
-	// pass rgba
-	glUniform4f(glGetUniformLocation(plot->gridProgram, "yColor"),
-	            (0xff & rgb >> 16) / 255.0,
-	            (0xff & rgb >> 8) / 255.0,
-	            (0xff & rgb) / 255.0,
-	            1.0f);	
-	
-	free(coords);
-	free(labels);
+	plot->statsStart = now;
+	plot->statsFrames = 0;
+	plot->statsPoints = 0;
+	plot->statsBytes = 0;
+	memset(plot->statsGpuMs, 0, sizeof(plot->statsGpuMs));
+	plot->statsGpuFrames = 0;
+
+	// the HUD only changes when the stats do
+	if (plot->hud)
+		updateHud(plot);
 }
 
-static void charHelper(float *addr, float x0, float y0, int xoff, int yoff, char ch) {
-	// get location of ch in image, which contains "0123456789.+-e "
-	int charIdx;
-	if ('0' <= ch && ch <= '9') charIdx = ch - '0';
-	else if (ch == '.') charIdx = 10;
-	else if (ch == '+') charIdx = 11;
-	else if (ch == '-') charIdx = 12;
-	else if (ch == 'e' || ch == 'E') charIdx = 13;
-	else charIdx = 14; // default to ' '
+// right-aligns a number in HUD_CHARS characters, dropping decimals as it
+// grows and then scaling it by k, M, or G (on top of the label's units), so
+// it's never cut off
+static void formatHud(char *str, double value) {
+	for (int decimals = 2; decimals >= 0; decimals--) {
+		if (snprintf(str, HUD_CHARS + 1, "%*.*f", HUD_CHARS, decimals, value) <= HUD_CHARS)
+			return;
+	}
 
-	// coordinates for vertices of each triangle
-	//          tri1       tri2
-	int dx[] = {0, 1, 0,   1, 0, 1};
-	int dy[] = {0, 0, 1,   0, 1, 1};
+	const char *prefixes = "kMG";
+	for (int i = 0; prefixes[i] != '\0'; i++) {
+		value *= 1.0e-3;
+		if (snprintf(str, HUD_CHARS + 1, "%*.2f%c", HUD_CHARS - 1, value, prefixes[i]) <= HUD_CHARS)
+			return;
+	}
 
-	for (int i = 0; i < 6; i++) {
-		// xbase, ybase (same for all)
-		addr[6*i + 0] = x0;
-		addr[6*i + 1] = y0;
-		// xoff, yoff
-		addr[6*i + 2] = xoff + dx[i];
-		addr[6*i + 3] = yoff + dy[i];
-		// tex coords
-		addr[6*i + 4] = (charIdx + dx[i]) / 15.0;
-		addr[6*i + 5] = 1 - dy[i];
+	snprintf(str, HUD_CHARS + 1, "%*.2e", HUD_CHARS, value * 1.0e9);
+}
+
+static void updateHud(QDSPplot *plot) {
+	// numbers, one row per label in images/hud.png
+	double values[HUD_ROWS] = {
+		plot->stats.fps,
+		plot->stats.pointsPerSec * 1.0e-6,
+		plot->stats.bytesPerSec * 1.0e-6,
+		plot->stats.gpuGridMs,
+		plot->stats.gpuPointsMs,
+		plot->stats.gpuTextMs
+	};
+
+	for (int i = 0; i < HUD_ROWS; i++) {
+		char str[HUD_CHARS + 1];
+		formatHud(str, values[i]);
+
+		// anchored at the top left corner, one character row per value
+		for (int j = 0; j < HUD_CHARS; j++)
+			glyphHelper(&plot->hudGlyphs[HUD_CHARS*i + j], -1, 1,
+			            HUD_LABEL_CHARS + j, -(i + 1), str[j]);
 	}
+	plot->textDirty = 1;
+
+	// frame-time graph, oldest sample first, scaled to the slowest frame
+	float maxMs = 1.0f;
+	for (int i = 0; i < QDSP_HUD_SAMPLES; i++)
+		if (plot->frameMs[i] > maxMs) maxMs = plot->frameMs[i];
+
+	for (int i = 0; i < QDSP_HUD_SAMPLES; i++) {
+		float ms = plot->frameMs[(plot->frameIdx + i) % QDSP_HUD_SAMPLES];
+		float xPix = i * plot->hudDims[0] / (float)(QDSP_HUD_SAMPLES - 1);
+		float yPix = plot->hudDims[1] - HUD_GRAPH_PIXELS * ms / maxMs;
+		plot->hudGraph[2*i + 0] = -1 + 2 * xPix / plot->width;
+		plot->hudGraph[2*i + 1] = 1 - 2 * yPix / plot->height;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, plot->hudGraphVBO);
+	glBufferSubData(GL_ARRAY_BUFFER, 0, 2 * QDSP_HUD_SAMPLES * sizeof(float),
+	                plot->hudGraph);
+}
+
+static double msDiff(const struct timespec *start, const struct timespec *end) {
+	return ((double)end->tv_sec*1.0e3 + end->tv_nsec*1.0e-6) -
+		((double)start->tv_sec*1.0e3 + start->tv_nsec*1.0e-6);
 }
 
 static void closeCallback(GLFWwindow *window) {
 	QDSPplot *plot = glfwGetWindowUserPointer(window);
-	plot->paused = 0;
+	for (int i = 0; i < plot->numPanels; i++)
+		plot->panels[i]->paused = 0;
 }
 
 static void resizeCallback(GLFWwindow *window, int width, int height) {
 	QDSPplot *plot = glfwGetWindowUserPointer(window);
 	glfwMakeContextCurrent(window);
 
+	// panels split the window evenly, in rows from the top
+	for (int i = 0; i < plot->numPanels; i++) {
+		QDSPplot *panel = plot->panels[i];
+		int x0 = width * panel->panelCol / panel->panelCols;
+		int x1 = width * (panel->panelCol + 1) / panel->panelCols;
+		int y0 = height * (panel->panelRows - panel->panelRow - 1) / panel->panelRows;
+		int y1 = height * (panel->panelRows - panel->panelRow) / panel->panelRows;
+		resizePanel(panel, x0, y0, x1 - x0, y1 - y0);
+	}
+
+	// minimizing can also shrink the window to nothing
+	int hidden = width == 0 || height == 0 || glfwGetWindowAttrib(window, GLFW_ICONIFIED);
+	for (int i = 0; i < plot->numPanels; i++)
+		plot->panels[i]->hidden = hidden;
+
+	if (plot->paused)
+		qdspRedraw(plot);
+}
+
+// uploads and redraws stop while minimized, and pick up again once the
+// window is back
+static void iconifyCallback(GLFWwindow *window, int iconified) {
+	QDSPplot *plot = glfwGetWindowUserPointer(window);
+	for (int i = 0; i < plot->numPanels; i++)
+		plot->panels[i]->hidden = iconified;
+	damageWindow(plot, DAMAGE_ALL);
+}
+
+// the window system lost what was on screen, e.g. the window was uncovered
+static void refreshCallback(GLFWwindow *window) {
+	damageWindow(glfwGetWindowUserPointer(window), DAMAGE_ALL);
+}
+
+static void resizePanel(QDSPplot *plot, int x, int y, int width, int height) {
 	glUseProgram(plot->overlayProgram);
 	glUniform2f(glGetUniformLocation(plot->overlayProgram, "pixDims"),
 	            width, height);
@@ -649,10 +4357,24 @@ static void resizeCallback(GLFWwindow *window, int width, int height) {
 	glUniform2f(glGetUniformLocation(plot->textProgram, "pixDims"),
 	            width, height);
 
-	glViewport(0, 0, width, height);
+	glUseProgram(plot->linesProgram);
+	glUniform2f(glGetUniformLocation(plot->linesProgram, "pixDims"),
+	            width, height);
 
-	if (plot->paused)
-		qdspRedraw(plot);
+	plot->panelX = x;
+	plot->panelY = y;
+	plot->width = width;
+	plot->height = height;
+	plot->damage = DAMAGE_ALL;
+
+	if (plot->persistFBO != 0)
+		resizePersistent(plot);
+	if (plot->streamFBO != 0)
+		resizeTarget(plot, &plot->streamFBO, &plot->streamTexture);
+
+	// graph is positioned in pixels
+	if (plot->hud)
+		updateHud(plot);
 }
 
 static void updateTitle(QDSPplot *plot) {
@@ -671,32 +4393,43 @@ static void updateTitle(QDSPplot *plot) {
 	free(curTitle);
 }
 
+// keys act on the panel under the cursor, except for closing, pausing and
+// freezing, which act on the whole window
 static void keyCallback(GLFWwindow *window, int key, int code, int action, int mods) {
-	QDSPplot *plot = glfwGetWindowUserPointer(window);
+	(void)code;
+	(void)mods;
+	QDSPplot *plot = ((QDSPplot*)glfwGetWindowUserPointer(window))->activePanel;
 	glfwMakeContextCurrent(window);
 	// ESC - close
 	// q - close
 	if ((key == GLFW_KEY_ESCAPE || key == GLFW_KEY_Q)
 	    && action == GLFW_PRESS) {
 		glfwSetWindowShouldClose(window, 1);
-		plot->paused = 0; // can't run cleanup code while paused
+		// can't run cleanup code while paused
+		for (int i = 0; i < plot->numPanels; i++)
+			plot->panels[i]->paused = 0;
 	}
 
 	// p - pause
 	if (key == GLFW_KEY_P && action == GLFW_PRESS) {
-		plot->paused = !plot->paused;
+		int paused = !plot->paused;
+		for (int i = 0; i < plot->numPanels; i++)
+			plot->panels[i]->paused = paused;
 		updateTitle(plot);
 	}
 
 	// f - freeze
 	if (key == GLFW_KEY_F && action == GLFW_PRESS) {
-		plot->frozen = !plot->frozen;
+		int frozen = !plot->frozen;
+		for (int i = 0; i < plot->numPanels; i++)
+			plot->panels[i]->frozen = frozen;
 		updateTitle(plot);
 	}
 	
 	// h - display help
 	if (key == GLFW_KEY_H && action == GLFW_PRESS) {
 		plot->overlay = !plot->overlay;
+		plot->damage |= DAMAGE_OVERLAY;
 
 		// redraw so the user can toggle the overlay while paused
 		qdspRedraw(plot);
@@ -704,12 +4437,485 @@ static void keyCallback(GLFWwindow *window, int key, int code, int action, int m
 
 	// g - toggle grid
 	if (key == GLFW_KEY_G && action == GLFW_PRESS) {
-		plot->grid = !plot->grid;
+		qdspSetGridVisible(plot, !plot->grid);
+		qdspRedraw(plot);
+	}
+
+	// r - reset view to the application's bounds
+	if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+		plot->userView = 0;
+		setView(plot, plot->homeXMin, plot->homeXMax,
+		        plot->homeYMin, plot->homeYMax);
+		qdspRedraw(plot);
+	}
+
+	// c - clear the selection
+	if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+		clearSelection(plot);
+		qdspRedraw(plot);
+	}
+
+	// s - toggle performance HUD
+	if (key == GLFW_KEY_S && action == GLFW_PRESS) {
+		plot->hud = !plot->hud;
+		plot->textDirty = 1;
+		plot->damage |= DAMAGE_OVERLAY;
+		if (plot->hud)
+			updateHud(plot);
 		qdspRedraw(plot);
 	}
 }
 
-static int makeShader(const char *filename, GLenum type) {
+// the mouse callbacks only change the view, so none of them redraw directly;
+// qdspUpdate redraws if the view changes while paused or frozen
+
+// zoom in or out around the cursor
+static void scrollCallback(GLFWwindow *window, double xoffset, double yoffset) {
+	(void)xoffset;
+	QDSPplot *plot = ((QDSPplot*)glfwGetWindowUserPointer(window))->activePanel;
+	glfwMakeContextCurrent(window);
+
+	double width, height;
+	panelSize(plot, &width, &height);
+	if (width <= 0 || height <= 0) return;
+
+	double cx = plot->xMin + (plot->xMax - plot->xMin) * plot->cursorX / width;
+	double cy = plot->yMax - (plot->yMax - plot->yMin) * plot->cursorY / height;
+	double scale = pow(ZOOM_STEP, -yoffset);
+
+	plot->userView = 1;
+	setView(plot,
+	        cx - (cx - plot->xMin) * scale, cx + (plot->xMax - cx) * scale,
+	        cy - (cy - plot->yMin) * scale, cy + (plot->yMax - cy) * scale);
+}
+
+// finds the panel under the cursor, and passes on the cursor position
+// relative to it
+static void cursorCallback(GLFWwindow *window, double xpos, double ypos) {
+	QDSPplot *owner = glfwGetWindowUserPointer(window);
+	glfwMakeContextCurrent(window);
+
+	double width, height;
+	panelSize(owner, &width, &height);
+	if (width <= 0 || height <= 0) return;
+
+	// drags, boxes and lassos stay in the panel they started in
+	QDSPplot *plot = owner->activePanel;
+	if (!plot->dragging && !plot->boxing && !plot->lassoing) {
+		int col = fmin(fmax(floor(xpos / width), 0), owner->panelCols - 1);
+		int row = fmin(fmax(floor(ypos / height), 0), owner->panelRows - 1);
+		plot = owner->panels[row * owner->panelCols + col];
+
+		// nothing is under the cursor in the panel it left
+		if (plot != owner->activePanel)
+			hoverPoint(owner->activePanel, -1);
+		owner->activePanel = plot;
+	}
+
+	moveCursor(plot, xpos - width * plot->panelCol, ypos - height * plot->panelRow);
+}
+
+// pan while dragging, or stretch the zoom box
+static void moveCursor(QDSPplot *plot, double xpos, double ypos) {
+	double width, height;
+	panelSize(plot, &width, &height);
+
+	if (plot->dragging && width > 0 && height > 0) {
+		double dx = (plot->xMax - plot->xMin) * (xpos - plot->cursorX) / width;
+		double dy = (plot->yMax - plot->yMin) * (ypos - plot->cursorY) / height;
+
+		plot->userView = 1;
+		setView(plot, plot->xMin - dx, plot->xMax - dx,
+		        plot->yMin + dy, plot->yMax + dy);
+	}
+
+	if (plot->boxing && width > 0 && height > 0) {
+		// outline in normalized device coords
+		float x0 = 2 * plot->boxX / width - 1;
+		float y0 = 1 - 2 * plot->boxY / height;
+		float x1 = 2 * xpos / width - 1;
+		float y1 = 1 - 2 * ypos / height;
+		float corners[] = {x0, y0, x1, y0, x1, y1, x0, y1};
+
+		glBindBuffer(GL_ARRAY_BUFFER, plot->boxVBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(corners), corners);
+		plot->damage |= DAMAGE_OVERLAY;
+	}
+
+	if (plot->lassoing)
+		addLasso(plot, xpos, ypos);
+
+	if (plot->hoverCallback)
+		plot->pickPending = 1;
+
+	plot->cursorX = xpos;
+	plot->cursorY = ypos;
+}
+
+// left button pans, right button selects a box to zoom to; with shift, they
+// draw a lasso or a box to select points in
+static void mouseCallback(GLFWwindow *window, int button, int action, int mods) {
+	QDSPplot *plot = ((QDSPplot*)glfwGetWindowUserPointer(window))->activePanel;
+	glfwMakeContextCurrent(window);
+	int shift = mods & GLFW_MOD_SHIFT;
+
+	if (button == GLFW_MOUSE_BUTTON_LEFT) {
+		plot->dragging = (action == GLFW_PRESS && !shift);
+
+		if (action == GLFW_PRESS && shift) {
+			plot->lassoing = 1;
+			plot->numLasso = 0;
+			addLasso(plot, plot->cursorX, plot->cursorY);
+		}
+
+		if (action == GLFW_RELEASE && plot->lassoing) {
+			plot->lassoing = 0;
+			plot->damage |= DAMAGE_OVERLAY;
+			if (plot->numLasso >= 3)
+				plot->selectPending = 1;
+		}
+	}
+
+	if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS) {
+		plot->boxing = 1;
+		plot->boxSelect = shift;
+		plot->boxX = plot->cursorX;
+		plot->boxY = plot->cursorY;
+		moveCursor(plot, plot->cursorX, plot->cursorY);
+	}
+
+	if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_RELEASE && plot->boxing) {
+		plot->boxing = 0;
+		plot->damage |= DAMAGE_OVERLAY;
+
+		double width, height;
+		panelSize(plot, &width, &height);
+
+		// ignore clicks, we only want actual boxes
+		if (fabs(plot->cursorX - plot->boxX) < 4 || fabs(plot->cursorY - plot->boxY) < 4)
+			return;
+
+		// a selection box is a lasso with four corners
+		if (plot->boxSelect) {
+			float x0 = 2 * plot->boxX / width - 1;
+			float y0 = 1 - 2 * plot->boxY / height;
+			float x1 = 2 * plot->cursorX / width - 1;
+			float y1 = 1 - 2 * plot->cursorY / height;
+			float corners[] = {x0, y0, x1, y0, x1, y1, x0, y1};
+
+			memcpy(plot->lasso, corners, sizeof(corners));
+			plot->numLasso = 4;
+			glBindBuffer(GL_ARRAY_BUFFER, plot->lassoVBO);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(corners), corners);
+			plot->selectPending = 1;
+			return;
+		}
+
+		double x0 = plot->xMin + (plot->xMax - plot->xMin) * plot->boxX / width;
+		double x1 = plot->xMin + (plot->xMax - plot->xMin) * plot->cursorX / width;
+		double y0 = plot->yMax - (plot->yMax - plot->yMin) * plot->boxY / height;
+		double y1 = plot->yMax - (plot->yMax - plot->yMin) * plot->cursorY / height;
+
+		plot->userView = 1;
+		setView(plot, fmin(x0, x1), fmax(x0, x1), fmin(y0, y1), fmax(y0, y1));
+	}
+}
+
+// the size of each panel in screen coordinates, which the cursor uses
+static void panelSize(QDSPplot *plot, double *width, double *height) {
+	int w, h;
+	glfwGetWindowSize(plot->window, &w, &h);
+	*width = (double)w / plot->panelCols;
+	*height = (double)h / plot->panelRows;
+}
+
+// adds the cursor position to the lasso, in normalized device coordinates
+static void addLasso(QDSPplot *plot, double xpos, double ypos) {
+	double width, height;
+	panelSize(plot, &width, &height);
+	if (plot->numLasso == QDSP_MAX_LASSO || width <= 0 || height <= 0)
+		return;
+
+	float x = 2 * xpos / width - 1;
+	float y = 1 - 2 * ypos / height;
+
+	// skip vertices right next to the last one
+	int n = plot->numLasso;
+	if (n > 0 && hypot((x - plot->lasso[2*n - 2]) * width / 2,
+	                   (y - plot->lasso[2*n - 1]) * height / 2) < LASSO_SPACING)
+		return;
+
+	plot->lasso[2*n] = x;
+	plot->lasso[2*n + 1] = y;
+	plot->numLasso++;
+
+	glBindBuffer(GL_ARRAY_BUFFER, plot->lassoVBO);
+	glBufferSubData(GL_ARRAY_BUFFER, 2 * n * sizeof(float), 2 * sizeof(float), &plot->lasso[2*n]);
+	plot->damage |= DAMAGE_OVERLAY;
+}
+
+static void clearSelection(QDSPplot *plot) {
+	// a selection still on the GPU is dropped too
+	if (plot->selectFence != NULL) {
+		glDeleteSync(plot->selectFence);
+		plot->selectFence = NULL;
+	}
+	plot->selectPending = 0;
+	plot->numSelected = 0;
+	plot->damage |= DAMAGE_OVERLAY;
+
+	if (plot->selectCallback)
+		plot->selectCallback(plot, NULL, 0, plot->selectData);
+}
+
+// reads back picks and selections the GPU has finished, and starts new ones,
+// for every panel in the window
+static void servicePicks(QDSPplot *plot) {
+	if (plot->closed || plot->hidden)
+		return;
+
+	for (int i = 0; i < plot->numPanels; i++) {
+		QDSPplot *panel = plot->panels[i];
+
+		if (panel->pickFence != NULL && fenceDone(panel->pickFence))
+			readPick(panel);
+		if (panel->selectFence != NULL && fenceDone(panel->selectFence))
+			readSelection(panel);
+
+		// one of each in flight at a time, and none from mapped buffers
+		if (panel->frameOpen && panel->frameMapped)
+			continue;
+		if (panel->pickPending && panel->pickFence == NULL)
+			pickPass(panel);
+		if (panel->selectPending && panel->selectFence == NULL)
+			selectPass(panel);
+	}
+}
+
+// draws the points around the cursor into the pick target, by their index
+static void pickPass(QDSPplot *plot) {
+	plot->pickPending = 0;
+	if (plot->hoverCallback == NULL)
+		return;
+
+	double width, height;
+	panelSize(plot, &width, &height);
+	if (plot->numPoints == 0 || width <= 0 || height <= 0 ||
+	    plot->cursorX < 0 || plot->cursorX >= width ||
+	    plot->cursorY < 0 || plot->cursorY >= height) {
+		hoverPoint(plot, -1);
+		return;
+	}
+
+	// the cursor in pixels from the bottom left of the panel; the panel's
+	// viewport is shifted so the pixels around it land in the target
+	int px = plot->cursorX * plot->width / width;
+	int py = (height - plot->cursorY) * plot->height / height;
+	unsigned int zero[4] = {0};
+
+	glBindFramebuffer(GL_FRAMEBUFFER, plot->pickFBO);
+	glViewport(PICK_RADIUS - px, PICK_RADIUS - py, plot->width, plot->height);
+	glScissor(0, 0, PICK_SIZE, PICK_SIZE);
+	glClearBufferuiv(GL_COLOR, 0, zero);
+
+	glUseProgram(plot->pickProgram);
+	bindFilter(plot);
+	for (int k = 0; k < plot->numSegments && segmentIndex(plot, k) >= 0; k++) {
+		glUniform1i(glGetUniformLocation(plot->pickProgram, "base"), segmentIndex(plot, k));
+		glBindVertexArray(plot->segments[k].vao);
+		glDrawArrays(GL_POINTS, 0, segmentSize(plot, k));
+	}
+
+	// read into the pixel buffer now, and map it once the GPU is done
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, plot->pickPBO);
+	glReadPixels(0, 0, PICK_SIZE, PICK_SIZE, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	plot->pickFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	plot->pickStride = plot->uploadStride;
+	glFlush();
+}
+
+// the nearest point to the cursor in a finished pick
+static void readPick(QDSPplot *plot) {
+	glDeleteSync(plot->pickFence);
+	plot->pickFence = NULL;
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, plot->pickPBO);
+	const unsigned int *ids = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+	                                           PICK_SIZE * PICK_SIZE * sizeof(unsigned int),
+	                                           GL_MAP_READ_BIT);
+	unsigned int best = 0;
+	int bestDist = INT_MAX;
+	if (ids != NULL) {
+		for (int y = 0; y < PICK_SIZE; y++) {
+			for (int x = 0; x < PICK_SIZE; x++) {
+				int dist = (x - PICK_RADIUS) * (x - PICK_RADIUS) + (y - PICK_RADIUS) * (y - PICK_RADIUS);
+				if (ids[y * PICK_SIZE + x] != 0 && dist < bestDist) {
+					best = ids[y * PICK_SIZE + x];
+					bestDist = dist;
+				}
+			}
+		}
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	// IDs are offset by one, and count points on the GPU
+	hoverPoint(plot, best != 0 ? (int)(best - 1) * plot->pickStride : -1);
+}
+
+// runs every point through the selection program, which keeps the indices of
+// the ones inside the box or lasso
+static void selectPass(QDSPplot *plot) {
+	plot->selectPending = 0;
+	plot->numSelected = 0;
+	plot->damage |= DAMAGE_OVERLAY;
+
+	if (plot->numPoints == 0) {
+		if (plot->selectCallback)
+			plot->selectCallback(plot, NULL, 0, plot->selectData);
+		return;
+	}
+
+	// room for every point to be selected, up to a buffer's worth; transform
+	// feedback drops anything past the end
+	size_t capacity = plot->numPoints;
+	if (capacity > SEGMENT_BYTES / sizeof(int))
+		capacity = SEGMENT_BYTES / sizeof(int);
+	glBindBuffer(GL_ARRAY_BUFFER, plot->selectVBO);
+	if (capacity > (size_t)plot->selectCapacity) {
+		glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(int), NULL, GL_DYNAMIC_COPY);
+		plot->selectCapacity = capacity;
+	}
+
+	// most points fail the bounding box, which is quicker than the polygon
+	float bounds[4] = {INFINITY, INFINITY, -INFINITY, -INFINITY};
+	for (int i = 0; i < plot->numLasso; i++) {
+		bounds[0] = fminf(bounds[0], plot->lasso[2*i]);
+		bounds[1] = fminf(bounds[1], plot->lasso[2*i + 1]);
+		bounds[2] = fmaxf(bounds[2], plot->lasso[2*i]);
+		bounds[3] = fmaxf(bounds[3], plot->lasso[2*i + 1]);
+	}
+
+	glUseProgram(plot->selectProgram);
+	glUniform1i(glGetUniformLocation(plot->selectProgram, "numLasso"), plot->numLasso);
+	glUniform4fv(glGetUniformLocation(plot->selectProgram, "lassoBounds"), 1, bounds);
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_BUFFER, plot->lassoTexture);
+	glActiveTexture(GL_TEXTURE0);
+	bindFilter(plot);
+
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, plot->selectVBO);
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, plot->selectQuery);
+	glBeginTransformFeedback(GL_POINTS);
+	for (int k = 0; k < plot->numSegments && segmentIndex(plot, k) >= 0; k++) {
+		// the point segments share is only selected once
+		int skip = (k > 0) ? plot->segmentOverlap : 0;
+		glUniform1i(glGetUniformLocation(plot->selectProgram, "base"), segmentIndex(plot, k));
+		glBindVertexArray(plot->segments[k].vao);
+		glDrawArrays(GL_POINTS, skip, segmentSize(plot, k) - skip);
+	}
+	glEndTransformFeedback();
+	glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+	glDisable(GL_RASTERIZER_DISCARD);
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+
+	plot->selectFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+}
+
+// highlights a finished selection and hands it to the application
+static void readSelection(QDSPplot *plot) {
+	glDeleteSync(plot->selectFence);
+	plot->selectFence = NULL;
+
+	int count;
+	glGetQueryObjectiv(plot->selectQuery, GL_QUERY_RESULT, &count);
+	plot->numSelected = count;
+	plot->damage |= DAMAGE_OVERLAY;
+
+	if (plot->selectCallback == NULL)
+		return;
+
+	// copied out, so the callback is free to draw
+	int *indices = NULL;
+	if (count > 0) {
+		indices = malloc(count * sizeof(int));
+		if (indices == NULL) {
+			fprintf(stderr, "Couldn't read back the selection\n");
+			return;
+		}
+		glBindBuffer(GL_COPY_READ_BUFFER, plot->selectVBO);
+		glGetBufferSubData(GL_COPY_READ_BUFFER, 0, count * sizeof(int), indices);
+	}
+
+	plot->selectCallback(plot, indices, count, plot->selectData);
+	free(indices);
+}
+
+// tells the application when the point under the cursor changes
+static void hoverPoint(QDSPplot *plot, int index) {
+	if (index == plot->hovered)
+		return;
+
+	plot->hovered = index;
+	if (plot->hoverCallback)
+		plot->hoverCallback(plot, index, plot->hoverData);
+}
+
+static int fenceDone(void *fence) {
+	GLenum status = glClientWaitSync(fence, 0, 0);
+	return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+}
+
+// compiles a shader; filtered ones get filter.glsl right after their #version
+// line, as a separate source string
+static int makeShader(const char *filename, GLenum type, int filtered) {
+	int size, filterSize = 0;
+	char *buf = readShader(filename, &size);
+	char *filter = filtered ? readShader("shaders/filter.glsl", &filterSize) : NULL;
+	if (buf == NULL || (filtered && filter == NULL)) {
+		free(buf);
+		free(filter);
+		return 0;
+	}
+
+	const GLchar *sources[3] = {buf, filter, NULL};
+	GLint sizes[3] = {size, filterSize, 0};
+	int count = 1;
+	if (filtered) {
+		char *eol = memchr(buf, '\n', size);
+		sizes[0] = eol ? eol - buf + 1 : size;
+		sources[2] = buf + sizes[0];
+		sizes[2] = size - sizes[0];
+		count = 3;
+	}
+
+	int shader = glCreateShader(type);
+	glShaderSource(shader, count, sources, sizes);
+	glCompileShader(shader);
+	free(buf);
+	free(filter);
+	
+	// error checking
+	int success;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+	if (!success) {
+		char log[1024];
+		glGetShaderInfoLog(shader, 1024, NULL, log);
+		fprintf(stderr, "Error compiling shader from file: %s\n", filename);
+		fprintf(stderr, "%s\n", log);
+		return 0;
+	}
+
+	return shader;
+}
+
+// reads a shader's source, which has to be freed afterwards
+static char *readShader(const char *filename, int *size) {
 	// will fail with a crazy-long filename, but users can't call this anyway
 	char fullpath[256];
 	resourcePath(fullpath, filename);
@@ -723,39 +4929,21 @@ static int makeShader(const char *filename, GLenum type) {
 	if (file == NULL) {
 		fprintf(stderr, "Could not find file: %s\n", fullpath);
 		fprintf(stderr, "Could not find file: ./%s\n", filename);
-		return 0;
+		return NULL;
 	}
 
 	// allocate memory
-	int size;
 	char *buf;
 	fseek(file, 0L, SEEK_END);
-	size = ftell(file); // file length
+	*size = ftell(file); // file length
 	rewind(file);
-	buf = malloc(size * sizeof(char));
+	buf = malloc(*size * sizeof(char));
 
-	fread(buf, 1, size, file);
+	if (buf != NULL)
+		fread(buf, 1, *size, file);
 
 	fclose(file);
-
-	int shader = glCreateShader(type);
-	glShaderSource(shader, 1, (const GLchar**)&buf, &size);
-	glCompileShader(shader);
-	
-	// error checking
-	int success;
-	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-	if (!success) {
-		char log[1024];
-		glGetShaderInfoLog(shader, 1024, NULL, log);
-		fprintf(stderr, "Error compiling shader from file: %s\n", filename);
-		fprintf(stderr, "%s\n", log);
-		free(buf);
-		return 0;
-	}
-
-	free(buf);
-	return shader;
+	return buf;
 }
 
 // load image with SOIL and pass to currently bound texture